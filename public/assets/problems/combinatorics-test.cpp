@@ -0,0 +1,125 @@
+#include "stanford.h"
+
+// Every arrangement a generator yields, copied out
+template <typename Gen> Vector<Vector<int>> collect(Gen gen) {
+  Vector<Vector<int>> all;
+  for (const Vector<int> &arrangement : gen) {
+    all.add(arrangement);
+  }
+  return all;
+}
+
+// The arrangements as a set, to check there are no repeats
+Set<Vector<int>> distinct(const Vector<Vector<int>> &all) {
+  Set<Vector<int>> result;
+  for (const Vector<int> &arrangement : all) {
+    result.add(arrangement);
+  }
+  return result;
+}
+
+// A queen in each row; the newest row must not share a column or a
+// diagonal with an earlier one
+bool queensSafe(VectorView<int> cols) {
+  int row = cols.size() - 1;
+  for (int r = 0; r < row; r++) {
+    if (abs(cols[r] - cols[row]) == row - r) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  cout << "--- Combinatorics Test ---" << endl;
+
+  Vector<int> none;
+  Vector<int> three = {1, 2, 3};
+
+  // Permutations: n! of them, all different
+  Vector<Vector<int>> perms = collect(permutationsOf(three));
+  EXPECT_EQUAL(perms.size(), 6);
+  EXPECT_EQUAL(distinct(perms).size(), 6);
+  EXPECT_EQUAL(perms[0], three);
+  EXPECT_EQUAL(collect(permutationsOf(Vector<int>({1, 2, 3, 4, 5}))).size(),
+               120);
+  EXPECT_EQUAL(collect(permutationsOf(none)), Vector<Vector<int>>({{}}));
+
+  // Combinations: n choose k, in order of position
+  Vector<Vector<int>> pairs = collect(combinationsOf(three, 2));
+  EXPECT_EQUAL(pairs, Vector<Vector<int>>({{1, 2}, {1, 3}, {2, 3}}));
+  EXPECT_EQUAL(collect(combinationsOf(three, 3)),
+               Vector<Vector<int>>({{1, 2, 3}}));
+  EXPECT_EQUAL(collect(combinationsOf(three, 0)), Vector<Vector<int>>({{}}));
+  EXPECT_EQUAL(collect(combinationsOf(three, 4)).size(), 0);
+  EXPECT_EQUAL(collect(combinationsOf(none, 0)).size(), 1);
+  EXPECT_EQUAL(collect(combinationsOf(none, 1)).size(), 0);
+  Vector<int> six = {1, 2, 3, 4, 5, 6};
+  EXPECT_EQUAL(collect(combinationsOf(six, 3)).size(), 20);
+
+  // Subsets: 2^n, starting from the empty set
+  Vector<Vector<int>> subsets = collect(subsetsOf(three));
+  EXPECT_EQUAL(subsets.size(), 8);
+  EXPECT_EQUAL(distinct(subsets).size(), 8);
+  EXPECT_EQUAL(subsets[0], Vector<int>());
+  EXPECT_EQUAL(distinct(subsets).contains({1, 3}), true);
+  EXPECT_EQUAL(collect(subsetsOf(none)), Vector<Vector<int>>({{}}));
+  EXPECT_EQUAL(collect(subsetsOf(six)).size(), 64);
+
+  // Breaking out of the loop stops the generator
+  int seen = 0;
+  for (const Vector<int> &p : permutationsOf(six)) {
+    if (++seen == 10) {
+      EXPECT_EQUAL(p.size(), 6);
+      break;
+    }
+  }
+  EXPECT_EQUAL(seen, 10);
+
+  // Pruned searches
+  Vector<int> columns = {0, 1, 2, 3, 4, 5, 6, 7};
+  Vector<int> firstSolution;
+  long long solutions = searchPermutations(
+      columns, queensSafe, [&](const Vector<int> &cols) {
+        if (firstSolution.isEmpty()) {
+          firstSolution = cols;
+        }
+      });
+  EXPECT_EQUAL(solutions, 92);
+  EXPECT_EQUAL(firstSolution, Vector<int>({0, 4, 7, 5, 2, 6, 1, 3}));
+  long long firstOnly = searchPermutations(
+      columns, queensSafe, [](const Vector<int> &) { return false; });
+  EXPECT_EQUAL(firstOnly, 1);
+
+  auto acceptAll = [](VectorView<int>) { return true; };
+  auto ignore = [](const Vector<int> &) {};
+  EXPECT_EQUAL(searchPermutations(none, acceptAll, ignore), 1);
+  EXPECT_EQUAL(searchPermutations(three, acceptAll, ignore), 6);
+  EXPECT_EQUAL(searchCombinations(six, 3, acceptAll, ignore), 20);
+  EXPECT_EQUAL(searchCombinations(three, 4, acceptAll, ignore), 0);
+  EXPECT_EQUAL(searchCombinations(three, 0, acceptAll, ignore), 1);
+  EXPECT_EQUAL(searchSubsets(six, acceptAll, ignore), 64);
+  EXPECT_EQUAL(searchSubsets(none, acceptAll, ignore), 1);
+
+  // Subsets of {1..6} that sum to 10, never growing a subset past it
+  auto atMostTen = [](VectorView<int> prefix) {
+    int sum = 0;
+    for (int i = 0; i < prefix.size(); i++) {
+      sum += prefix[i];
+    }
+    return sum <= 10;
+  };
+  int sumsToTen = 0;
+  searchSubsets(six, atMostTen, [&](const Vector<int> &subset) {
+    int sum = 0;
+    for (int x : subset) {
+      sum += x;
+    }
+    if (sum == 10) {
+      sumsToTen++;
+    }
+  });
+  EXPECT_EQUAL(sumsToTen, 5);
+
+  return 0;
+}
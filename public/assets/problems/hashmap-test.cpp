@@ -0,0 +1,46 @@
+#include "stanford.h"
+
+int main() {
+  cout << "--- HashMap Test ---" << endl;
+
+  HashMap<string, Vector<string>> paths;
+  for (int i = 0; i < 7; i++) {
+    paths["k" + integerToString(i)] = {"a", "b", "c"};
+  }
+
+  // Assigning one entry to another while the insert grows the table
+  paths["new"] = paths["k0"];
+  EXPECT_EQUAL(paths["new"], paths["k0"]);
+  paths.put("z", paths.get("k1"));
+  EXPECT_EQUAL(paths.get("z").size(), 3);
+
+  // A reference stays valid however many entries are added after it
+  const Vector<string> &held = paths["k2"];
+  for (int i = 0; i < 1000; i++) {
+    paths["m" + integerToString(i)] = held;
+  }
+  EXPECT_EQUAL(held.size(), 3);
+  EXPECT_EQUAL(paths["m999"], held);
+
+  // Iteration can update values but not keys
+  HashMap<string, int> counts = {{"a", 1}, {"b", 2}};
+  for (pair<const string, int> &entry : counts) {
+    entry.second *= 10;
+  }
+  for (auto &entry : counts) {
+    entry.second++;
+  }
+  EXPECT_EQUAL(counts.get("a"), 11);
+  EXPECT_EQUAL(counts.get("b"), 21);
+  EXPECT_EQUAL(counts.containsKey("a"), true);
+
+  HashSet<string> words = {"alpha", "beta", "gamma", "delta"};
+  const string &first = *words.begin();
+  for (int i = 0; i < 100; i++) {
+    words.add(first + integerToString(i));
+  }
+  words.add(*words.begin());
+  EXPECT_EQUAL(words.size(), 104);
+
+  return 0;
+}
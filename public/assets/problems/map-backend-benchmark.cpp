@@ -0,0 +1,69 @@
+#include "stanford.h"
+#include <chrono>
+
+// Compares Map's node-based TreeBackend with the sorted-array FlatBackend
+// on building, looking up and iterating maps of a few sizes. Use Run Fast:
+// a debug run times the stepping instrumentation, not the containers.
+
+template <typename Fn> double timeMs(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct Result {
+  double insert, lookup, iterate;
+  long long checksum;
+};
+
+template <typename Backend> Result run(const Vector<int> &keys, int rounds) {
+  Result r = {0, 0, 0, 0};
+  Map<int, int, Backend> map;
+  r.insert = timeMs([&] {
+    for (int key : keys) {
+      map[key] = key / 2;
+    }
+  });
+  r.lookup = timeMs([&] {
+    for (int round = 0; round < rounds; round++) {
+      for (int key : keys) {
+        r.checksum += map.get(key);
+      }
+    }
+  });
+  r.iterate = timeMs([&] {
+    for (int round = 0; round < rounds; round++) {
+      for (const auto &entry : map) {
+        r.checksum += entry.second;
+      }
+    }
+  });
+  return r;
+}
+
+int main() {
+  cout << "--- Map Backend Benchmark ---" << endl;
+  cout << "size  op        tree ms   flat ms" << endl;
+
+  for (int size : {50, 1000, 5000}) {
+    Vector<int> keys;
+    for (int i = 0; i < size; i++) {
+      keys.add((int)((i * 2654435761u) % 1000003));
+    }
+    // About a million lookups and visits at every size
+    int rounds = 1000000 / size;
+    Result tree = run<TreeBackend>(keys, rounds);
+    Result flat = run<FlatBackend>(keys, rounds);
+    EXPECT_EQUAL(tree.checksum, flat.checksum);
+
+    cout << size << "  insert   " << tree.insert << "  " << flat.insert
+         << endl;
+    cout << size << "  lookup   " << tree.lookup << "  " << flat.lookup
+         << endl;
+    cout << size << "  iterate  " << tree.iterate << "  " << flat.iterate
+         << endl;
+  }
+
+  return 0;
+}
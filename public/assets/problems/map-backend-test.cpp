@@ -0,0 +1,36 @@
+#include "stanford.h"
+
+int main() {
+  cout << "--- Map Backend Test ---" << endl;
+
+  // Putting one of a flat map's own values under a new key
+  Map<string, string, FlatBackend> m;
+  m["a"] = "a value long enough to live on the heap";
+  m["b"] = "b";
+  m.put("0", m.get("a"));
+  EXPECT_EQUAL(m.get("0"), m.get("a"));
+  for (int i = 0; i < 100; i++) {
+    m.put(integerToString(i), m["b"]);
+  }
+  EXPECT_EQUAL(m.get("99"), "b");
+  EXPECT_EQUAL(m.size(), 102);
+
+  Map<int, Vector<int>, FlatBackend> v;
+  v[3] = {1, 2, 3};
+  v.put(0, v[3]);
+  EXPECT_EQUAL(v[0], v[3]);
+
+  // Both backends keep the same ordered behaviour
+  Map<int, int, TreeBackend> tree;
+  Map<int, int, FlatBackend> flat;
+  for (int i = 0; i < 50; i++) {
+    tree[(i * 17) % 50] = i;
+    flat[(i * 17) % 50] = i;
+  }
+  EXPECT_EQUAL(tree.firstKey(), flat.firstKey());
+  EXPECT_EQUAL(tree.lastKey(), flat.lastKey());
+  EXPECT_EQUAL(tree.keys(), flat.keys());
+  EXPECT_EQUAL(tree.values(), flat.values());
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include "stanford.h"
+
+// Counts how often elements are copied and moved, so the tests can check
+// that rvalue and emplace paths never copy
+int copies = 0;
+int moves = 0;
+
+struct Counted {
+  int value;
+  Counted(int v = 0) : value(v) {}
+  Counted(const Counted &other) : value(other.value) { copies++; }
+  Counted(Counted &&other) noexcept : value(other.value) { moves++; }
+  Counted &operator=(const Counted &other) {
+    value = other.value;
+    copies++;
+    return *this;
+  }
+  Counted &operator=(Counted &&other) noexcept {
+    value = other.value;
+    moves++;
+    return *this;
+  }
+};
+bool operator<(const Counted &a, const Counted &b) { return a.value < b.value; }
+bool operator==(const Counted &a, const Counted &b) {
+  return a.value == b.value;
+}
+ostream &operator<<(ostream &os, const Counted &c) { return os << c.value; }
+
+void resetCounts() {
+  copies = 0;
+  moves = 0;
+}
+
+int main() {
+  cout << "--- Move Semantics Test ---" << endl;
+
+  Vector<Counted> v;
+  v.reserve(8);
+  resetCounts();
+  v.add(Counted(1));
+  EXPECT_EQUAL(moves, 1);
+  v.emplace_back(2);
+  v.insert(0, Counted(0));
+  v.emplace(3, 3);
+  EXPECT_EQUAL(copies, 0);
+  EXPECT_EQUAL(v.size(), 4);
+  Counted removed = v.remove(0);
+  EXPECT_EQUAL(removed.value, 0);
+  EXPECT_EQUAL(copies, 0);
+
+  // An rvalue left operand is reused, not copied
+  resetCounts();
+  Vector<Counted> joined = std::move(v) + Counted(4);
+  EXPECT_EQUAL(copies, 0);
+  EXPECT_EQUAL(joined.size(), 4);
+  Vector<Counted> other = {Counted(5)};
+  resetCounts();
+  Vector<Counted> all = std::move(joined) + std::move(other);
+  EXPECT_EQUAL(copies, 0);
+  EXPECT_EQUAL(all.size(), 5);
+
+  Stack<Counted> s;
+  s.reserve(8);
+  resetCounts();
+  s.push(Counted(1));
+  EXPECT_EQUAL(moves, 1);
+  s.emplace(2);
+  Counted top = s.pop();
+  EXPECT_EQUAL(top.value, 2);
+  EXPECT_EQUAL(copies, 0);
+
+  // Pushing the stack's own top while it grows copies it before the move
+  Stack<string> words;
+  for (int i = 0; i < 8; i++) {
+    words.push("word" + integerToString(i));
+  }
+  words.emplace(words.peek());
+  EXPECT_EQUAL(words.peek(), "word7");
+  Stack<Vector<int>> vectors;
+  for (int i = 0; i < 16; i++) {
+    vectors.push({i, i});
+  }
+  vectors.emplace(vectors.peek());
+  vectors.push(vectors.peek());
+  EXPECT_EQUAL(vectors.size(), 18);
+  EXPECT_EQUAL(vectors.peek(), Vector<int>({15, 15}));
+
+  Queue<Counted> q;
+  q.reserve(8);
+  resetCounts();
+  q.enqueue(Counted(1));
+  EXPECT_EQUAL(moves, 1);
+  q.emplace(2);
+  Counted front = q.dequeue();
+  EXPECT_EQUAL(front.value, 1);
+  EXPECT_EQUAL(copies, 0);
+
+  Set<Counted> set;
+  resetCounts();
+  set.add(Counted(2));
+  set.emplace(1);
+  EXPECT_EQUAL(copies, 0);
+  EXPECT_EQUAL(set.size(), 2);
+
+  // Growing moves the elements rather than copying them
+  Vector<Counted> growing;
+  resetCounts();
+  for (int i = 0; i < 100; i++) {
+    growing.emplace_back(i);
+  }
+  EXPECT_EQUAL(copies, 0);
+
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include "stanford.h"
+#include <chrono>
+
+// Times a lazy filter/transform/take pipeline against the loop it stands
+// for and against building a Vector at every step. Use Run Fast: a debug
+// run times the stepping instrumentation, not the pipeline.
+
+template <typename Fn> double timeMs(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  cout << "--- Ranges Benchmark ---" << endl;
+
+  Vector<int> nums;
+  for (int i = 0; i < 100000; i++) {
+    nums.add((i * 7919) % 1000);
+  }
+  auto isOdd = [](int x) { return x % 2 == 1; };
+  auto square = [](int x) { return (long long)x * x; };
+  const int rounds = 200;
+
+  long long loopSum = 0;
+  double loopMs = timeMs([&] {
+    for (int round = 0; round < rounds; round++) {
+      int taken = 0;
+      for (int x : nums) {
+        if (taken == 50000) {
+          break;
+        }
+        if (isOdd(x)) {
+          loopSum += square(x);
+          taken++;
+        }
+      }
+    }
+  });
+
+  long long pipelineSum = 0;
+  double pipelineMs = timeMs([&] {
+    for (int round = 0; round < rounds; round++) {
+      for (long long y : nums | lazy::filter(isOdd) | lazy::transform(square) |
+                             lazy::take(50000)) {
+        pipelineSum += y;
+      }
+    }
+  });
+  EXPECT_EQUAL(pipelineSum, loopSum);
+
+  // Building the same result with an intermediate Vector per step
+  long long eagerSum = 0;
+  double eagerMs = timeMs([&] {
+    for (int round = 0; round < rounds; round++) {
+      Vector<int> odds;
+      for (int x : nums) {
+        if (isOdd(x)) {
+          odds.add(x);
+        }
+      }
+      Vector<long long> squares;
+      for (int x : odds) {
+        squares.add(square(x));
+      }
+      for (int i = 0; i < 50000 && i < squares.size(); i++) {
+        eagerSum += squares[i];
+      }
+    }
+  });
+  EXPECT_EQUAL(eagerSum, loopSum);
+
+  cout << "hand loop:         " << loopMs << " ms" << endl;
+  cout << "lazy pipeline:     " << pipelineMs << " ms" << endl;
+  cout << "eager Vectors:     " << eagerMs << " ms" << endl;
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include "stanford.h"
+
+// A student's own filter and reduce must still be the ones called
+Vector<int> filter(const Vector<int> &v, bool (*keep)(int)) {
+  Vector<int> result;
+  for (int x : v) {
+    if (keep(x)) {
+      result.add(x);
+    }
+  }
+  return result;
+}
+
+int reduce(const Vector<int> &v, int init, int (*combine)(int, int)) {
+  for (int x : v) {
+    init = combine(init, x);
+  }
+  return init;
+}
+
+bool isEven(int x) { return x % 2 == 0; }
+int add(int a, int b) { return a + b; }
+
+int main() {
+  cout << "--- Ranges Test ---" << endl;
+
+  Vector<int> v = {1, 2, 3, 4, 5, 6};
+  Vector<int> evens = filter(v, isEven);
+  EXPECT_EQUAL(evens, Vector<int>({2, 4, 6}));
+  EXPECT_EQUAL(reduce(v, 0, add), 21);
+
+  // The lazy versions, by name and as a pipeline
+  EXPECT_EQUAL(lazy::toVector(lazy::filter(v, isEven)), evens);
+  EXPECT_EQUAL(lazy::reduce(lazy::filter(v, isEven), 0, add), 12);
+  Vector<int> squares = v | lazy::transform([](int x) { return x * x; }) |
+                        lazy::take(3) | lazy::toVector();
+  EXPECT_EQUAL(squares, Vector<int>({1, 4, 9}));
+  for (auto [i, x] : lazy::enumerate(v)) {
+    if (i == 5) {
+      EXPECT_EQUAL(x, 6);
+    }
+  }
+
+  // take over filter stops asking once it has enough
+  int tested = 0;
+  auto countedEven = [&](int x) {
+    tested++;
+    return x % 2 == 0;
+  };
+  Vector<int> firstTwo =
+      lazy::toVector(lazy::take(lazy::filter(v, countedEven), 2));
+  EXPECT_EQUAL(firstTwo, Vector<int>({2, 4}));
+  EXPECT_EQUAL(tested, 4);
+  EXPECT_EQUAL(v | lazy::filter(isEven) | lazy::take(10) | lazy::toVector(),
+               evens);
+  EXPECT_EQUAL(v | lazy::filter(isEven) | lazy::take(0) | lazy::toVector(),
+               Vector<int>());
+
+  // enumerate counts from 0 and passes elements by reference
+  Vector<int> indexed = {5, 5, 5};
+  for (auto [i, x] : indexed | lazy::enumerate()) {
+    x += i;
+  }
+  EXPECT_EQUAL(indexed, Vector<int>({5, 6, 7}));
+  int weighted = 0;
+  for (auto [i, x] : lazy::enumerate(lazy::filter(v, isEven))) {
+    weighted += i * x;
+  }
+  EXPECT_EQUAL(weighted, 0 * 2 + 1 * 4 + 2 * 6);
+
+  // Grid rows
+  Grid<int> grid(2, 3);
+  for (int r = 0; r < 2; r++) {
+    for (int c = 0; c < 3; c++) {
+      grid[r][c] = r * 3 + c;
+    }
+  }
+  auto rowSum = [](const vector<int> &row) {
+    int sum = 0;
+    for (int x : row) {
+      sum += x;
+    }
+    return sum;
+  };
+  EXPECT_EQUAL(grid.rows() | lazy::transform(rowSum) | lazy::toVector(),
+               Vector<int>({3, 12}));
+  EXPECT_EQUAL(lazy::reduce(grid.rows() | lazy::transform(rowSum), 0, add),
+               15);
+
+  // Map entries, in key order
+  Map<string, int> ages = {{"ann", 31}, {"bob", 17}, {"cy", 45}, {"di", 12}};
+  auto isAdult = [](const auto &entry) { return entry.second >= 18; };
+  auto keyOf = [](const auto &entry) { return entry.first; };
+  Vector<string> adults = ages | lazy::filter(isAdult) |
+                          lazy::transform(keyOf) | lazy::toVector();
+  EXPECT_EQUAL(adults, Vector<string>({"ann", "cy"}));
+  Vector<string> firstKeys =
+      ages | lazy::transform(keyOf) | lazy::take(2) | lazy::toVector();
+  EXPECT_EQUAL(firstKeys, Vector<string>({"ann", "bob"}));
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "stanford.h"
+#include <chrono>
+#include <iomanip>
+
+// Conversions per second for strlib's number functions against the string
+// stream versions they replaced. Use Run Fast: a debug run times the
+// stepping instrumentation, not the conversions.
+
+string streamIntegerToString(int n) {
+  ostringstream stream;
+  stream << n;
+  return stream.str();
+}
+
+int streamStringToInteger(const string &str) {
+  istringstream stream(trim(str));
+  int value;
+  stream >> value;
+  if (stream.fail() || !stream.eof())
+    error("streamStringToInteger: Illegal integer format");
+  return value;
+}
+
+string streamRealToString(double d) {
+  ostringstream stream;
+  stream << uppercase << d;
+  return stream.str();
+}
+
+double streamStringToReal(const string &str) {
+  istringstream stream(trim(str));
+  double value;
+  stream >> value;
+  if (stream.fail() || !stream.eof())
+    error("streamStringToReal: Illegal floating-point format");
+  return value;
+}
+
+template <typename Fn> double perSecond(int count, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return count / std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+  cout << "--- Strlib Conversion Benchmark ---" << endl;
+  const int count = 200000;
+
+  long long streamSum = 0, strlibSum = 0;
+  double streamInts = perSecond(count, [&] {
+    for (int i = 0; i < count; i++) {
+      streamSum += streamStringToInteger(streamIntegerToString(i * 7919 - i));
+    }
+  });
+  double strlibInts = perSecond(count, [&] {
+    for (int i = 0; i < count; i++) {
+      strlibSum += stringToInteger(integerToString(i * 7919 - i));
+    }
+  });
+  EXPECT_EQUAL(strlibSum, streamSum);
+
+  double streamTotal = 0, strlibTotal = 0;
+  double streamReals = perSecond(count, [&] {
+    for (int i = 0; i < count; i++) {
+      streamTotal += streamStringToReal(streamRealToString(i / 7.0));
+    }
+  });
+  double strlibReals = perSecond(count, [&] {
+    for (int i = 0; i < count; i++) {
+      strlibTotal += stringToReal(realToString(i / 7.0));
+    }
+  });
+  EXPECT_EQUAL(strlibTotal, streamTotal);
+
+  cout << fixed << setprecision(2);
+  cout << "round trips per second (millions)   stream   strlib" << endl;
+  cout << "integer                             " << streamInts / 1e6 << "     "
+       << strlibInts / 1e6 << endl;
+  cout << "real                                " << streamReals / 1e6
+       << "     " << strlibReals / 1e6 << endl;
+
+  return 0;
+}
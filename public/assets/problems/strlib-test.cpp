@@ -8,6 +8,49 @@ int main() {
   EXPECT_EQUAL(stringToInteger("42"), 42);
   EXPECT_EQUAL(boolToString(true), "true");
 
+  // Numeric text: surrounding spaces, a sign, and 0x in radix 16
+  EXPECT_EQUAL(stringToInteger(" -42 "), -42);
+  EXPECT_EQUAL(stringToInteger("+7"), 7);
+  EXPECT_EQUAL(stringToInteger("0x1F", 16), 31);
+  EXPECT_EQUAL(stringToInteger("-ff", 16), -255);
+  EXPECT_EQUAL(stringIsInteger("0x", 16), false);
+  EXPECT_EQUAL(stringIsInteger("0x10"), false);
+  EXPECT_EQUAL(stringIsInteger("12 3"), false);
+  EXPECT_EQUAL(stringIsInteger(""), false);
+
+  // Overflow is rejected rather than wrapped
+  EXPECT_EQUAL(stringIsInteger("2147483647"), true);
+  EXPECT_EQUAL(stringIsInteger("2147483648"), false);
+  EXPECT_EQUAL(stringToInteger("-2147483648"), -2147483647 - 1);
+  EXPECT_EQUAL(stringIsInteger("-2147483649"), false);
+  EXPECT_EQUAL(stringIsLong("9223372036854775807"), true);
+  EXPECT_EQUAL(stringIsLong("9223372036854775808"), false);
+
+  // Octal and hex print the two's complement bits of negative numbers
+  EXPECT_EQUAL(integerToString(255, 16), "ff");
+  EXPECT_EQUAL(integerToString(-1, 16), "ffffffff");
+  EXPECT_EQUAL(integerToString(-8, 8), "37777777770");
+  EXPECT_EQUAL(longToString(-1L, 16), "ffffffffffffffff");
+
+  // Every radix from 2 to 36 is its own base, signed
+  EXPECT_EQUAL(integerToString(5, 2), "101");
+  EXPECT_EQUAL(integerToString(-5, 2), "-101");
+  EXPECT_EQUAL(integerToString(35, 36), "z");
+  EXPECT_EQUAL(stringToInteger("101", 2), 5);
+  EXPECT_EQUAL(stringToInteger("ZZ", 36), 1295);
+  EXPECT_EQUAL(stringIsInteger("12", 2), false);
+
+  // Reals print like ostream << uppercase: %G, six significant digits
+  EXPECT_EQUAL(realToString(0.1), "0.1");
+  EXPECT_EQUAL(realToString(100.0), "100");
+  EXPECT_EQUAL(realToString(1234567.0), "1.23457E+06");
+  EXPECT_EQUAL(realToString(1e-5), "1E-05");
+  EXPECT_EQUAL(stringToReal(" 2.5e3 "), 2500.0);
+  EXPECT_EQUAL(stringIsReal("inf"), false);
+  EXPECT_EQUAL(stringIsReal("nan"), false);
+  EXPECT_EQUAL(stringIsReal("0x1p3"), false);
+  EXPECT_EQUAL(stringIsReal("1e999"), false);
+
   string s = "  hello  ";
   EXPECT_EQUAL(trim(s), "hello");
   EXPECT_EQUAL(toUpperCase("abc"), "ABC");
@@ -18,5 +61,35 @@ int main() {
 
   EXPECT_EQUAL(stringJoin(v, "-"), "a-b-c");
 
+  // The view functions read literals, strings and views in place. The text
+  // is longer than the short-string buffer, so a copy would allocate
+  string padded = "   a line long enough to need its own heap block   ";
+  std::string_view view = padded;
+  size_t before = _debug_allocation_count;
+  std::string_view trimmed = trimView(padded);
+  bool viewChecks = trimStartView(view).size() == 48 &&
+                    trimEndView(view).size() == 48 &&
+                    trimView("   a literal that is long enough to matter   ")
+                            .size() == 39 &&
+                    startsWith(padded, "   a line") &&
+                    startsWith(view, ' ') && endsWith(view, "block   ") &&
+                    endsWith("a literal long enough to matter", 'r') &&
+                    stringContains(padded, "heap") &&
+                    stringContains(view, 'k') &&
+                    stringContains("a literal long enough to matter", "lit");
+  size_t allocations = _debug_allocation_count - before;
+  EXPECT_EQUAL(viewChecks, true);
+  EXPECT_EQUAL(allocations, 0);
+  EXPECT_EQUAL(trimmed, "a line long enough to need its own heap block");
+
+  // Symbols work wherever a string is read
+  Symbol sym("  Hello  ");
+  EXPECT_EQUAL(trim(sym), "Hello");
+  EXPECT_EQUAL(toLowerCase(sym), "  hello  ");
+  EXPECT_EQUAL(stringContains(sym, "ell"), true);
+  EXPECT_EQUAL(stringIndexOf(sym, "l"), 4);
+  EXPECT_EQUAL(startsWith(sym, "  H"), true);
+  EXPECT_EQUAL(stringToInteger(Symbol("42")), 42);
+
   return 0;
 }
@@ -0,0 +1,334 @@
+#pragma once
+#include "common.h"
+#include "vector.h"
+#include <iterator>
+#include <type_traits>
+
+// ============================================================
+// combinatorics - permutations, combinations and subsets
+// ============================================================
+// Generators that step through every arrangement of a Vector without
+// building them all first:
+//
+//   for (const Vector<int> &p : permutationsOf(nums)) ...
+//   for (const Vector<string> &team : combinationsOf(players, 3)) ...
+//   for (const Vector<int> &s : subsetsOf(nums)) ...
+//
+// Each generator keeps one Vector and rearranges it in place between
+// steps, so memory stays O(n) however many arrangements there are, and
+// breaking out of the loop ends the work. The Vector handed out is only
+// valid until the next step; copy it (Vector<int> best = p;) to keep it.
+//
+// For backtracking, searchPermutations, searchCombinations and
+// searchSubsets build arrangements one element at a time and ask
+// accept(prefix) about each partial one. Returning false skips every
+// arrangement that starts with that prefix.
+
+// Shared iterator: the generator owns the state, the iterator just
+// asks it to step until it runs out
+template <typename Gen> class _GeneratorIterator {
+private:
+  Gen *_gen;
+
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = typename Gen::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type *;
+  using reference = const value_type &;
+
+  explicit _GeneratorIterator(Gen *gen) : _gen(gen) {}
+  const value_type &operator*() const { return _gen->_current; }
+  const value_type *operator->() const { return &_gen->_current; }
+  _GeneratorIterator &operator++() {
+    if (!_gen->_advance())
+      _gen = nullptr;
+    return *this;
+  }
+  bool operator==(const _GeneratorIterator &other) const {
+    return _gen == other._gen;
+  }
+  bool operator!=(const _GeneratorIterator &other) const {
+    return !(*this == other);
+  }
+};
+
+// ============================================================
+// Permutations - Heap's algorithm
+// ============================================================
+// Each step swaps a single pair of elements, so n! permutations cost
+// n! swaps. They do not come out in sorted order, and repeated elements
+// give repeated permutations.
+
+template <typename T> class Permutations {
+private:
+  Vector<T> _elements, _current;
+  vector<int> _counters;
+  int _level = 1;
+
+  bool _advance() {
+    int n = _current.size();
+    while (_level < n) {
+      int &count = _counters[_level];
+      if (count < _level) {
+        std::swap(_current[_level % 2 == 0 ? 0 : count], _current[_level]);
+        count++;
+        _level = 1;
+        return true;
+      }
+      count = 0;
+      _level++;
+    }
+    return false;
+  }
+
+  friend class _GeneratorIterator<Permutations>;
+
+public:
+  using value_type = Vector<T>;
+  using iterator = _GeneratorIterator<Permutations>;
+
+  explicit Permutations(const Vector<T> &elements) : _elements(elements) {}
+
+  iterator begin() {
+    _current = _elements;
+    _counters.assign(_elements.size(), 0);
+    _level = 1;
+    return iterator(this);
+  }
+  iterator end() { return iterator(nullptr); }
+};
+
+// ============================================================
+// Combinations - k of n in lexicographic order of position
+// ============================================================
+// Elements keep their relative order: combinationsOf({a, b, c}, 2)
+// gives {a, b}, {a, c}, {b, c}.
+
+template <typename T> class Combinations {
+private:
+  Vector<T> _elements, _current;
+  vector<int> _indices;
+  int _k;
+
+  bool _advance() {
+    int n = _elements.size();
+    int i = _k - 1;
+    while (i >= 0 && _indices[i] == n - _k + i)
+      i--;
+    if (i < 0)
+      return false;
+    _indices[i]++;
+    for (int j = i; j < _k; j++) {
+      if (j > i)
+        _indices[j] = _indices[j - 1] + 1;
+      _current[j] = _elements.get(_indices[j]);
+    }
+    return true;
+  }
+
+  friend class _GeneratorIterator<Combinations>;
+
+public:
+  using value_type = Vector<T>;
+  using iterator = _GeneratorIterator<Combinations>;
+
+  Combinations(const Vector<T> &elements, int k)
+      : _elements(elements), _k(k) {
+    if (k < 0)
+      error("Combinations: k must not be negative");
+  }
+
+  iterator begin() {
+    if (_k > _elements.size())
+      return end();
+    _indices.resize(_k);
+    for (int i = 0; i < _k; i++)
+      _indices[i] = i;
+    _current = _elements.subList(0, _k);
+    return iterator(this);
+  }
+  iterator end() { return iterator(nullptr); }
+};
+
+// ============================================================
+// Subsets - Gray code order
+// ============================================================
+// Consecutive subsets differ by one element added or removed, starting
+// from the empty set. Members keep their order from the original Vector.
+
+template <typename T> class Subsets {
+private:
+  Vector<T> _elements, _current;
+  unsigned long long _mask = 0, _step = 0;
+
+  bool _advance() {
+    if (++_step >> _elements.size())
+      return false;
+    // Gray code: step k toggles the element at k's lowest set bit
+    int bit = __builtin_ctzll(_step);
+    int rank = __builtin_popcountll(_mask & ((1ULL << bit) - 1));
+    _mask ^= 1ULL << bit;
+    if (_mask >> bit & 1)
+      _current.insert(rank, _elements.get(bit));
+    else
+      _current.remove(rank);
+    return true;
+  }
+
+  friend class _GeneratorIterator<Subsets>;
+
+public:
+  using value_type = Vector<T>;
+  using iterator = _GeneratorIterator<Subsets>;
+
+  explicit Subsets(const Vector<T> &elements) : _elements(elements) {
+    if (elements.size() > 62)
+      error("Subsets: Too many elements (at most 62)");
+  }
+
+  iterator begin() {
+    _current.clear();
+    _current.reserve(_elements.size());
+    _mask = _step = 0;
+    return iterator(this);
+  }
+  iterator end() { return iterator(nullptr); }
+};
+
+template <typename T>
+Permutations<T> permutationsOf(const Vector<T> &elements) {
+  return Permutations<T>(elements);
+}
+
+template <typename T>
+Combinations<T> combinationsOf(const Vector<T> &elements, int k) {
+  return Combinations<T>(elements, k);
+}
+
+template <typename T> Subsets<T> subsetsOf(const Vector<T> &elements) {
+  return Subsets<T>(elements);
+}
+
+// ============================================================
+// Backtracking search with pruning
+// ============================================================
+// accept is called with a VectorView of each partial arrangement, the
+// newest element last. visit is called with each complete arrangement
+// and may return false to stop the search. Each search returns the
+// number of arrangements visited. The search keeps an explicit stack
+// instead of recursing, so depth is limited only by memory.
+
+template <typename Visit, typename Arg>
+bool _keepSearching(Visit &visit, const Arg &arg) {
+  if constexpr (std::is_void_v<std::invoke_result_t<Visit &, const Arg &>>) {
+    visit(arg);
+    return true;
+  } else {
+    return visit(arg);
+  }
+}
+
+template <typename T, typename Accept, typename Visit>
+long long searchPermutations(const Vector<T> &elements, Accept accept,
+                             Visit visit) {
+  Vector<T> current = elements;
+  int n = current.size();
+  // choice[d]: index swapped into position d, or -1 before the first
+  vector<int> choice(n, -1);
+  long long visited = 0;
+  int depth = 0;
+  while (depth >= 0) {
+    if (depth == n) {
+      visited++;
+      if (!_keepSearching(visit, current))
+        break;
+      depth--;
+      continue;
+    }
+    int &i = choice[depth];
+    if (i >= 0)
+      std::swap(current[depth], current[i]);
+    i = i < 0 ? depth : i + 1;
+    if (i == n) {
+      i = -1;
+      depth--;
+      continue;
+    }
+    std::swap(current[depth], current[i]);
+    if (accept(current.slice(0, depth + 1)))
+      depth++;
+  }
+  return visited;
+}
+
+template <typename T, typename Accept, typename Visit>
+long long searchCombinations(const Vector<T> &elements, int k, Accept accept,
+                             Visit visit) {
+  if (k < 0)
+    error("searchCombinations: k must not be negative");
+  int n = elements.size();
+  Vector<T> current;
+  current.reserve(k);
+  // next[d]: index of the next element to try in position d
+  vector<int> next = {0};
+  long long visited = 0;
+  if (k == 0) {
+    _keepSearching(visit, current);
+    return 1;
+  }
+  while (!next.empty()) {
+    int depth = next.size() - 1;
+    if (current.size() > depth)
+      current.remove(depth);
+    int i = next[depth]++;
+    // Too few elements left to fill the remaining positions
+    if (i > n - (k - depth)) {
+      next.pop_back();
+      continue;
+    }
+    current.add(elements.get(i));
+    if (!accept(current.slice(0)))
+      continue;
+    if (depth + 1 < k) {
+      next.push_back(i + 1);
+    } else {
+      visited++;
+      if (!_keepSearching(visit, current))
+        break;
+    }
+  }
+  return visited;
+}
+
+// Subsets are built by adding elements in their original order, and the
+// empty set is always visited first
+template <typename T, typename Accept, typename Visit>
+long long searchSubsets(const Vector<T> &elements, Accept accept,
+                        Visit visit) {
+  int n = elements.size();
+  Vector<T> current;
+  current.reserve(n);
+  vector<int> next = {0};
+  long long visited = 1;
+  if (!_keepSearching(visit, current))
+    return visited;
+  while (!next.empty()) {
+    int depth = next.size() - 1;
+    if (current.size() > depth)
+      current.remove(depth);
+    int i = next[depth]++;
+    if (i >= n) {
+      next.pop_back();
+      continue;
+    }
+    current.add(elements.get(i));
+    if (!accept(current.slice(0)))
+      continue;
+    visited++;
+    if (!_keepSearching(visit, current))
+      break;
+    next.push_back(i + 1);
+  }
+  return visited;
+}
@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <initializer_list>
@@ -32,3 +33,161 @@ void error(string msg) {
   exit(1);
 }
 #endif
+
+// ============================================================
+// Checking Policy
+// ============================================================
+// Vector, Grid, Stack and Queue take a checking policy as their last
+// template parameter:
+//   FullChecks  - Stanford range checks, then checked std access (.at)
+//   SingleCheck - Stanford range checks only
+//   NoChecks    - no checks at all, for timed runs
+// The default comes from STANFORD_CHECKS, which the worker sets per run
+// mode (Debug keeps FullChecks, Run Fast uses NoChecks).
+
+struct FullChecks {
+  static constexpr bool check = true;
+  static constexpr bool recheck = true;
+};
+struct SingleCheck {
+  static constexpr bool check = true;
+  static constexpr bool recheck = false;
+};
+struct NoChecks {
+  static constexpr bool check = false;
+  static constexpr bool recheck = false;
+};
+
+#ifndef STANFORD_CHECKS
+#define STANFORD_CHECKS FullChecks
+#endif
+using DefaultChecks = STANFORD_CHECKS;
+
+// Element access after the policy's own range check has run
+template <typename Checks, typename Seq>
+auto _checked_at(Seq &seq, size_t i) -> decltype(seq[i]) {
+  if constexpr (Checks::recheck)
+    return seq.at(i);
+  else
+    return seq[i];
+}
+
+// ============================================================
+// Hashing
+// ============================================================
+// std::hash is specialized for GridLocation and the Stanford containers,
+// so they work as HashMap/HashSet keys (e.g. memoizing on a Vector).
+// Containers hash their elements in iteration order: equal containers
+// hash equally, and reordering elements changes the hash.
+
+// splitmix64 finalizer: every input bit affects every output bit
+uint64_t _hashMix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+size_t _hashCombine(size_t seed, size_t h) {
+  return (size_t)_hashMix(seed + 0x9E3779B97F4A7C15ULL + h);
+}
+
+template <typename It> size_t _hashRange(It begin, It end, size_t seed = 0) {
+  using Elem = std::decay_t<decltype(*begin)>;
+  for (; begin != end; ++begin)
+    seed = _hashCombine(seed, std::hash<Elem>()(*begin));
+  return seed;
+}
+
+// ============================================================
+// Copy-on-Write Storage
+// ============================================================
+// Defining STANFORD_COW before including the library makes copies of
+// Vector, Map, Set and Grid share one reference-counted buffer, cloned on
+// the first write through any of the copies. Passing those containers by
+// value is then O(1). Containers read their storage through _read() and
+// write through _write(); anything that can hand out a mutable reference
+// (operator[], non-const begin()) counts as a write.
+
+template <typename S> class _CowStorage {
+private:
+  struct _Block {
+    int refs;
+    S data;
+  };
+  _Block *_b = nullptr;
+
+  static const S &_empty() {
+    static const S empty;
+    return empty;
+  }
+  void _drop() {
+    if (_b && --_b->refs == 0)
+      delete _b;
+    _b = nullptr;
+  }
+
+public:
+  _CowStorage() {}
+  _CowStorage(const _CowStorage &other) : _b(other._b) {
+    if (_b)
+      _b->refs++;
+  }
+  _CowStorage(_CowStorage &&other) noexcept : _b(other._b) {
+    other._b = nullptr;
+  }
+  _CowStorage &operator=(const _CowStorage &other) {
+    if (other._b)
+      other._b->refs++;
+    _drop();
+    _b = other._b;
+    return *this;
+  }
+  _CowStorage &operator=(_CowStorage &&other) noexcept {
+    if (this != &other) {
+      _drop();
+      std::swap(_b, other._b);
+    }
+    return *this;
+  }
+  ~_CowStorage() { _drop(); }
+
+  const S &read() const { return _b ? _b->data : _empty(); }
+  S &write() {
+    if (!_b) {
+      _b = new _Block{1, S()};
+    } else if (_b->refs > 1) {
+      _b->refs--;
+      _b = new _Block{1, _b->data};
+    }
+    return _b->data;
+  }
+  // Replace the contents without cloning a shared buffer first
+  void assign(S &&data) {
+    _drop();
+    _b = new _Block{1, std::move(data)};
+  }
+  void reset() { _drop(); }
+  int owners() const { return _b ? _b->refs : 1; }
+  const void *buffer() const { return _b; }
+};
+
+template <typename S> class _PlainStorage {
+private:
+  S _s;
+
+public:
+  const S &read() const { return _s; }
+  S &write() { return _s; }
+  void assign(S &&data) { _s = std::move(data); }
+  void reset() { _s.clear(); }
+  int owners() const { return 1; }
+  const void *buffer() const { return &_s; }
+};
+
+#ifdef STANFORD_COW
+template <typename S> using _Shareable = _CowStorage<S>;
+#else
+template <typename S> using _Shareable = _PlainStorage<S>;
+#endif
@@ -233,6 +233,11 @@ map<void *, HeapInfo> _heap_registrations;
 // Re-entrancy guard for memory hooks
 bool _in_mem_hook = false;
 
+// Every operator new call from user or library code, including blocks
+// already freed again; tests compare it before and after a call to check
+// that the call does not allocate
+size_t _debug_allocation_count = 0;
+
 // Common helper to register raw allocation
 void _debug_register_allocation(void *p, size_t size, bool is_array) {
   if (!p)
@@ -292,12 +297,41 @@ void _debug_update_heap_info(T *ptr, const char *typeName) {
   _debug_depth--;
 }
 
+// toDebugString helper for containers with copy-on-write storage (see
+// STANFORD_COW in common.h). A buffer with several owners is described
+// once, on its heap registration, and every owner renders as a "Shared"
+// link to it; a buffer back down to one owner renders inline again.
+template <typename Storage>
+string _debug_shared(const Storage &storage, const string &json) {
+  bool old_hook = _in_mem_hook;
+  _in_mem_hook = true;
+  string result = json;
+  auto it = _heap_registrations.find(const_cast<void *>(storage.buffer()));
+  if (storage.owners() > 1 && it != _heap_registrations.end()) {
+    it->second.type = "shared";
+    it->second.value = json;
+    stringstream ss;
+    ss << "{\"__type\": \"Shared\", \"buffer\": \"" << storage.buffer()
+       << "\", \"owners\": " << storage.owners() << "}";
+    result = ss.str();
+  } else if (it != _heap_registrations.end() &&
+             it->second.type == "shared") {
+    stringstream ss;
+    ss << "Allocated (" << it->second.size << " bytes)";
+    it->second.type = "raw";
+    it->second.value = ss.str();
+  }
+  _in_mem_hook = old_hook;
+  return result;
+}
+
 // Global overrides for new/delete to track heap allocations
 void *operator new(size_t size) {
   if (_in_mem_hook) {
     return malloc(size);
   }
   _in_mem_hook = true;
+  _debug_allocation_count++;
   void *p = malloc(size);
   _debug_register_allocation(p, size, false);
   _in_mem_hook = false;
@@ -309,6 +343,7 @@ void *operator new[](size_t size) {
     return malloc(size);
   }
   _in_mem_hook = true;
+  _debug_allocation_count++;
   void *p = malloc(size);
   _debug_register_allocation(p, size, true);
   _in_mem_hook = false;
@@ -407,8 +442,8 @@ void _debug_loop_step(int line, const char *name, const T &val) {
 
 #define EXPECT_EQUAL(actual, expected)                                         \
   {                                                                            \
-    auto a = (actual);                                                         \
-    auto e = (expected);                                                       \
+    const auto &a = (actual);                                                  \
+    const auto &e = (expected);                                                \
     if (a == e) {                                                              \
       cout << "[TEST:PASS] " << #actual << " == " << #expected << endl;        \
     } else {                                                                   \
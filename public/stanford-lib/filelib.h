@@ -0,0 +1,223 @@
+#pragma once
+#include "common.h"
+#include "vector.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+// ============================================================
+// filelib - reading and writing files
+// ============================================================
+// Files live in the in-memory file system the program runs on, which
+// holds any input files attached in the editor. Besides the Stanford
+// functions (openFile, readLines, readEntireFile, writeEntireFile) this
+// has a LineReader for large inputs:
+//
+//   for (string_view line : LineReader("data.txt")) ...
+//
+// reads the file in large blocks and hands out each line as a view into
+// its buffer, so a multi-megabyte file is read without allocating a
+// string per line.
+
+bool fileExists(const string &filename) {
+  FILE *file = fopen(filename.c_str(), "rb");
+  if (file)
+    fclose(file);
+  return file != nullptr;
+}
+
+bool openFile(ifstream &stream, const string &filename) {
+  stream.clear();
+  stream.open(filename);
+  return !stream.fail();
+}
+
+bool openFile(ofstream &stream, const string &filename) {
+  stream.clear();
+  stream.open(filename);
+  return !stream.fail();
+}
+
+// ============================================================
+// LineReader - a file's lines as string_views
+// ============================================================
+// Lines are split at '\n' and lose a trailing '\r', so files saved on
+// Windows read the same. A line is only valid until the next one is
+// read; copy it into a string to keep it.
+
+class LineReader {
+private:
+  static constexpr size_t kDefaultBuffer = 1 << 16;
+
+  FILE *_file = nullptr;
+  string _filename;
+  // Unread text is [_start, _end) of _buffer
+  vector<char> _buffer;
+  size_t _start = 0, _end = 0;
+  bool _eof = false;
+  int _lineNumber = 0;
+
+  // Moves the unread text to the front and reads more after it, growing
+  // the buffer when a single line fills all of it
+  bool _fill() {
+    if (_eof)
+      return false;
+    if (_start > 0) {
+      memmove(_buffer.data(), _buffer.data() + _start, _end - _start);
+      _end -= _start;
+      _start = 0;
+    }
+    if (_end == _buffer.size())
+      _buffer.resize(_buffer.size() * 2);
+    size_t count =
+        fread(_buffer.data() + _end, 1, _buffer.size() - _end, _file);
+    _end += count;
+    if (count == 0)
+      _eof = true;
+    return count > 0;
+  }
+
+public:
+  class iterator {
+  private:
+    LineReader *_reader;
+    std::string_view _line;
+
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = const std::string_view &;
+
+    explicit iterator(LineReader *reader) : _reader(reader) {
+      if (_reader && !_reader->next(_line))
+        _reader = nullptr;
+    }
+    const std::string_view &operator*() const { return _line; }
+    const std::string_view *operator->() const { return &_line; }
+    iterator &operator++() {
+      if (!_reader->next(_line))
+        _reader = nullptr;
+      return *this;
+    }
+    bool operator==(const iterator &other) const {
+      return _reader == other._reader;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  explicit LineReader(const string &filename,
+                      size_t bufferSize = kDefaultBuffer)
+      : _filename(filename), _buffer(std::max<size_t>(bufferSize, 1)) {
+    _file = fopen(filename.c_str(), "rb");
+    if (!_file)
+      error("LineReader: Couldn't open file " + filename);
+  }
+  LineReader(const LineReader &) = delete;
+  LineReader &operator=(const LineReader &) = delete;
+  ~LineReader() {
+    if (_file)
+      fclose(_file);
+  }
+
+  // Reads the next line into line; false once the file is used up
+  bool next(std::string_view &line) {
+    while (true) {
+      const char *first = _buffer.data() + _start;
+      const char *newline = (const char *)memchr(first, '\n', _end - _start);
+      if (newline || (!_fill() && _start < _end)) {
+        if (!newline)
+          newline = _buffer.data() + _end; // last line, no '\n'
+        first = _buffer.data() + _start;
+        size_t length = newline - first;
+        _start = std::min(_end, _start + length + 1);
+        if (length > 0 && first[length - 1] == '\r')
+          length--;
+        line = std::string_view(first, length);
+        _lineNumber++;
+        return true;
+      }
+      if (_start == _end && _eof)
+        return false;
+    }
+  }
+
+  // Number of lines read so far
+  int lineNumber() const { return _lineNumber; }
+  const string &filename() const { return _filename; }
+
+  iterator begin() { return iterator(this); }
+  iterator end() { return iterator(nullptr); }
+
+  string toDebugString() const {
+    return _json_val(_filename + ", line " + to_string(_lineNumber));
+  }
+};
+
+// ============================================================
+// Whole-file helpers
+// ============================================================
+
+// The file's contents, read with a single allocation of its size
+string readEntireFile(const string &filename) {
+  FILE *file = fopen(filename.c_str(), "rb");
+  if (!file)
+    error("readEntireFile: Couldn't open file " + filename);
+  string contents;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    long size = ftell(file);
+    if (size > 0) {
+      contents.resize(size);
+      rewind(file);
+      contents.resize(fread(&contents[0], 1, size, file));
+    }
+  }
+  fclose(file);
+  return contents;
+}
+
+// Reads the rest of the stream into lines (Stanford signature)
+void readEntireFile(istream &is, Vector<string> &lines) {
+  lines.clear();
+  string line;
+  while (getline(is, line))
+    lines.add(line);
+}
+
+Vector<string> readLines(istream &is) {
+  Vector<string> lines;
+  readEntireFile(is, lines);
+  return lines;
+}
+
+Vector<string> readLines(const string &filename) {
+  Vector<string> lines;
+  for (std::string_view line : LineReader(filename))
+    lines.add(string(line));
+  return lines;
+}
+
+bool writeEntireFile(const string &filename, std::string_view text,
+                     bool append = false) {
+  FILE *file = fopen(filename.c_str(), append ? "ab" : "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+  return fclose(file) == 0 && ok;
+}
+
+// Writes each line followed by '\n'
+bool writeLines(const string &filename, const Vector<string> &lines,
+                bool append = false) {
+  FILE *file = fopen(filename.c_str(), append ? "ab" : "wb");
+  if (!file)
+    return false;
+  bool ok = true;
+  for (const string &line : lines) {
+    ok = ok && fwrite(line.data(), 1, line.size(), file) == line.size() &&
+         fputc('\n', file) != EOF;
+  }
+  return fclose(file) == 0 && ok;
+}
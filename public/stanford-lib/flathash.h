@@ -0,0 +1,395 @@
+#pragma once
+#include "common.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// ============================================================
+// FlatHashTable - open-addressing hash table for HashMap/HashSet
+// ============================================================
+// SwissTable-style layout: elements live in one flat slot array, and a
+// parallel array holds one control byte per slot (empty, deleted, or the
+// low 7 bits of the element's hash). Lookups probe groups of 8 control
+// bytes at a time, matching all 8 with a few 64-bit word operations, and
+// only compare keys whose 7 hash bits match.
+//
+// The table grows (doubling) once it would be more than 7/8 full, which
+// invalidates iterators. Iteration order is the slot order: unspecified,
+// but the same for every traversal of an unmodified table.
+//
+// T is the stored element; KeyOf extracts its key. By default elements
+// sit in the slots themselves and move when the table grows. With Stable
+// set, slots point into an _ElementArena instead, so growing only moves
+// pointers and references to elements stay valid until they are erased,
+// as with std::unordered_map. HashMap and HashSet need that: user code
+// such as m["new"] = m["old"] holds a reference across an insert.
+
+// Memory for elements that never move: blocks that double in size, with
+// erased elements' memory reused first
+template <typename T> class _ElementArena {
+private:
+  vector<std::pair<T *, size_t>> _blocks;
+  size_t _used = 0; // elements handed out from the last block
+  vector<T *> _free;
+
+  void _addBlock(size_t n) {
+    _blocks.push_back({std::allocator<T>().allocate(n), n});
+    _used = 0;
+  }
+
+public:
+  _ElementArena() {}
+  _ElementArena(_ElementArena &&other) noexcept { swap(other); }
+  _ElementArena &operator=(_ElementArena &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~_ElementArena() { clear(); }
+
+  void swap(_ElementArena &other) noexcept {
+    std::swap(_blocks, other._blocks);
+    std::swap(_used, other._used);
+    std::swap(_free, other._free);
+  }
+
+  // Uninitialized memory for one element
+  T *allocate() {
+    if (!_free.empty()) {
+      T *p = _free.back();
+      _free.pop_back();
+      return p;
+    }
+    if (_blocks.empty() || _used == _blocks.back().second)
+      _addBlock(_blocks.empty() ? 8 : _blocks.back().second * 2);
+    return _blocks.back().first + _used++;
+  }
+  // Takes back memory whose element has been destroyed
+  void deallocate(T *p) { _free.push_back(p); }
+
+  // Makes room for n more elements in one block
+  void reserve(size_t n) {
+    size_t spare = _free.size();
+    if (!_blocks.empty())
+      spare += _blocks.back().second - _used;
+    if (spare < n)
+      _addBlock(n - _free.size());
+  }
+
+  // Frees every block; the elements must already be destroyed
+  void clear() {
+    for (auto &block : _blocks)
+      std::allocator<T>().deallocate(block.first, block.second);
+    _blocks.clear();
+    _free.clear();
+    _used = 0;
+  }
+};
+
+template <typename T, typename Key, typename KeyOf,
+          typename Hash = std::hash<Key>, bool Stable = false>
+class FlatHashTable {
+private:
+  using _Slot = std::conditional_t<Stable, T *, T>;
+  struct _NoArena {};
+
+  static constexpr size_t kGroupWidth = 8;
+  static constexpr size_t kNotFound = (size_t)-1;
+  static constexpr int8_t kEmpty = -128; // 0b10000000
+  static constexpr int8_t kDeleted = -2; // 0b11111110
+  static constexpr uint64_t kLsbs = 0x0101010101010101ULL;
+  static constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+
+  int8_t *_ctrl = nullptr;
+  _Slot *_slots = nullptr;
+  size_t _capacity = 0; // always 0 or a power of two >= kGroupWidth
+  size_t _size = 0;
+  size_t _growthLeft = 0;
+  std::conditional_t<Stable, _ElementArena<T>, _NoArena> _arena;
+
+  static T &_deref(_Slot &slot) {
+    if constexpr (Stable)
+      return *slot;
+    else
+      return slot;
+  }
+  T &_at(size_t i) const { return _deref(_slots[i]); }
+
+  template <typename... Args> void _construct(size_t i, Args &&...args) {
+    if constexpr (Stable) {
+      _slots[i] = _arena.allocate();
+      new (_slots[i]) T(std::forward<Args>(args)...);
+    } else {
+      new (&_slots[i]) T(std::forward<Args>(args)...);
+    }
+  }
+  void _destroy(size_t i) {
+    _at(i).~T();
+    if constexpr (Stable)
+      _arena.deallocate(_slots[i]);
+  }
+
+  static uint64_t _hash(const Key &key) {
+    // Spread the bits: std::hash<int> is the identity in libc++
+    uint64_t h = (uint64_t)Hash()(key) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 32);
+  }
+  static int8_t _h2(uint64_t h) { return (int8_t)(h & 0x7F); }
+  static size_t _maxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+  uint64_t _loadGroup(size_t group) const {
+    uint64_t word;
+    std::memcpy(&word, _ctrl + group * kGroupWidth, sizeof(word));
+    return word;
+  }
+  // Bit 7 of each byte in the result is set where the group matches
+  static uint64_t _matchByte(uint64_t word, int8_t b) {
+    uint64_t x = word ^ (kLsbs * (uint8_t)b);
+    return (x - kLsbs) & ~x & kMsbs;
+  }
+  static uint64_t _matchEmpty(uint64_t word) {
+    return word & ~(word << 6) & kMsbs;
+  }
+  static uint64_t _matchEmptyOrDeleted(uint64_t word) {
+    return word & ~(word << 7) & kMsbs;
+  }
+  static size_t _lowestByte(uint64_t mask) {
+    return __builtin_ctzll(mask) >> 3;
+  }
+
+  size_t _find(const Key &key, uint64_t h) const {
+    if (_capacity == 0)
+      return kNotFound;
+    size_t groupMask = _capacity / kGroupWidth - 1;
+    size_t group = (h >> 7) & groupMask;
+    for (size_t step = 1;; step++) {
+      uint64_t word = _loadGroup(group);
+      for (uint64_t m = _matchByte(word, _h2(h)); m; m &= m - 1) {
+        size_t i = group * kGroupWidth + _lowestByte(m);
+        if (KeyOf()(_at(i)) == key)
+          return i;
+      }
+      if (_matchEmpty(word))
+        return kNotFound;
+      group = (group + step) & groupMask; // triangular probing
+    }
+  }
+
+  size_t _findInsertSlot(uint64_t h) const {
+    size_t groupMask = _capacity / kGroupWidth - 1;
+    size_t group = (h >> 7) & groupMask;
+    for (size_t step = 1;; step++) {
+      uint64_t m = _matchEmptyOrDeleted(_loadGroup(group));
+      if (m)
+        return group * kGroupWidth + _lowestByte(m);
+      group = (group + step) & groupMask;
+    }
+  }
+
+  void _allocate(size_t capacity) {
+    _capacity = capacity;
+    _ctrl = new int8_t[capacity];
+    std::memset(_ctrl, (uint8_t)kEmpty, capacity);
+    _slots = std::allocator<_Slot>().allocate(capacity);
+    _growthLeft = _maxLoad(capacity);
+  }
+
+  void _release() {
+    if (!_ctrl)
+      return;
+    for (size_t i = 0; i < _capacity; i++) {
+      if (_ctrl[i] >= 0)
+        _at(i).~T();
+    }
+    if constexpr (Stable)
+      _arena.clear();
+    delete[] _ctrl;
+    std::allocator<_Slot>().deallocate(_slots, _capacity);
+    _ctrl = nullptr;
+    _slots = nullptr;
+    _capacity = _size = _growthLeft = 0;
+  }
+
+  void _rehash(size_t newCapacity) {
+    int8_t *oldCtrl = _ctrl;
+    _Slot *oldSlots = _slots;
+    size_t oldCapacity = _capacity;
+    _allocate(newCapacity);
+    for (size_t i = 0; i < oldCapacity; i++) {
+      if (oldCtrl[i] < 0)
+        continue;
+      uint64_t h = _hash(KeyOf()(_deref(oldSlots[i])));
+      size_t j = _findInsertSlot(h);
+      new (&_slots[j]) _Slot(std::move(oldSlots[i]));
+      oldSlots[i].~_Slot();
+      _ctrl[j] = _h2(h);
+    }
+    _growthLeft -= _size;
+    if (oldCtrl) {
+      delete[] oldCtrl;
+      std::allocator<_Slot>().deallocate(oldSlots, oldCapacity);
+    }
+  }
+
+  static size_t _capacityFor(size_t n) {
+    size_t capacity = kGroupWidth;
+    while (_maxLoad(capacity) < n)
+      capacity *= 2;
+    return capacity;
+  }
+
+  template <bool Const> class _Iterator {
+  private:
+    using Table = std::conditional_t<Const, const FlatHashTable, FlatHashTable>;
+    Table *_table;
+    size_t _i;
+    void _skipEmpty() {
+      while (_i < _table->_capacity && _table->_ctrl[_i] < 0)
+        _i++;
+    }
+    friend class FlatHashTable;
+    template <bool> friend class _Iterator;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T *, T *>;
+    using reference = std::conditional_t<Const, const T &, T &>;
+
+    _Iterator(Table *table, size_t i) : _table(table), _i(i) { _skipEmpty(); }
+    _Iterator(const _Iterator<false> &other)
+        : _table(other._table), _i(other._i) {}
+
+    reference operator*() const { return _table->_at(_i); }
+    pointer operator->() const { return &_table->_at(_i); }
+    _Iterator &operator++() {
+      _i++;
+      _skipEmpty();
+      return *this;
+    }
+    _Iterator operator++(int) {
+      _Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const _Iterator &other) const { return _i == other._i; }
+    bool operator!=(const _Iterator &other) const { return _i != other._i; }
+  };
+
+public:
+  using iterator = _Iterator<false>;
+  using const_iterator = _Iterator<true>;
+
+  FlatHashTable() {}
+  FlatHashTable(const FlatHashTable &other) { *this = other; }
+  FlatHashTable(FlatHashTable &&other) noexcept { *this = std::move(other); }
+  ~FlatHashTable() { _release(); }
+
+  FlatHashTable &operator=(const FlatHashTable &other) {
+    if (this == &other)
+      return *this;
+    _release();
+    if (other._capacity == 0)
+      return *this;
+    // Copy slot-for-slot so the copy iterates in the same order
+    _allocate(other._capacity);
+    if constexpr (Stable)
+      _arena.reserve(other._size);
+    std::memcpy(_ctrl, other._ctrl, _capacity);
+    for (size_t i = 0; i < _capacity; i++) {
+      if (_ctrl[i] >= 0)
+        _construct(i, other._at(i));
+    }
+    _size = other._size;
+    _growthLeft = other._growthLeft;
+    return *this;
+  }
+  FlatHashTable &operator=(FlatHashTable &&other) noexcept {
+    if (this == &other)
+      return *this;
+    _release();
+    std::swap(_ctrl, other._ctrl);
+    std::swap(_slots, other._slots);
+    std::swap(_capacity, other._capacity);
+    std::swap(_size, other._size);
+    std::swap(_growthLeft, other._growthLeft);
+    std::swap(_arena, other._arena);
+    return *this;
+  }
+
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+  size_t capacity() const { return _capacity; }
+  void clear() { _release(); }
+
+  // Makes room for n elements without further rehashing
+  void reserve(size_t n) {
+    if (n > _size + _growthLeft)
+      _rehash(_capacityFor(n));
+    if constexpr (Stable) {
+      if (n > _size)
+        _arena.reserve(n - _size);
+    }
+  }
+
+  iterator find(const Key &key) {
+    size_t i = _find(key, _hash(key));
+    return i == kNotFound ? end() : iterator(this, i);
+  }
+  const_iterator find(const Key &key) const {
+    size_t i = _find(key, _hash(key));
+    return i == kNotFound ? end() : const_iterator(this, i);
+  }
+  bool contains(const Key &key) const {
+    return _find(key, _hash(key)) != kNotFound;
+  }
+
+  // Constructs T from args only if key is not present yet
+  template <typename... Args>
+  std::pair<iterator, bool> tryEmplace(const Key &key, Args &&...args) {
+    uint64_t h = _hash(key);
+    size_t i = _find(key, h);
+    if (i != kNotFound)
+      return {iterator(this, i), false};
+    if (_growthLeft == 0) {
+      // Mostly tombstones: clean up in place; otherwise grow
+      _rehash(_size < _maxLoad(_capacity) / 2 ? _capacity
+                                              : _capacityFor(_size + 1));
+    }
+    i = _findInsertSlot(h);
+    _construct(i, std::forward<Args>(args)...);
+    if (_ctrl[i] == kEmpty)
+      _growthLeft--;
+    _ctrl[i] = _h2(h);
+    _size++;
+    return {iterator(this, i), true};
+  }
+
+  iterator erase(const_iterator pos) {
+    size_t i = pos._i;
+    _destroy(i);
+    // A group that already has an empty slot stops every probe that
+    // reaches it, so the freed slot can become empty again; otherwise a
+    // tombstone keeps later elements in the probe chain reachable
+    if (_matchEmpty(_loadGroup(i / kGroupWidth))) {
+      _ctrl[i] = kEmpty;
+      _growthLeft++;
+    } else {
+      _ctrl[i] = kDeleted;
+    }
+    _size--;
+    return iterator(this, i + 1);
+  }
+  size_t erase(const Key &key) {
+    size_t i = _find(key, _hash(key));
+    if (i == kNotFound)
+      return 0;
+    erase(const_iterator(this, i));
+    return 1;
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, _capacity); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, _capacity); }
+};
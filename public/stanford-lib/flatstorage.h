@@ -0,0 +1,165 @@
+#pragma once
+#include "common.h"
+
+// ============================================================
+// Ordered storage backends for Map and Set
+// ============================================================
+// Map and Set take a backend as their last template parameter:
+//   TreeBackend - std::map / std::set, one heap node per element
+//   FlatBackend - one sorted contiguous array (FlatMap / FlatSet below)
+// The flat backend looks keys up by binary search and iterates with a
+// linear scan, which is several times faster for collections that are
+// built once and then mostly read. Inserting or erasing shifts the tail
+// of the array, so each of those is O(n), and unlike TreeBackend it
+// invalidates references to the map's other elements.
+// The default comes from STANFORD_ORDERED_BACKEND.
+
+template <typename K, typename V> class FlatMap {
+public:
+  // Unlike std::map the key is not const; changing it through an
+  // iterator breaks the ordering
+  using value_type = std::pair<K, V>;
+  using iterator = typename vector<value_type>::iterator;
+  using const_iterator = typename vector<value_type>::const_iterator;
+  using reverse_iterator = typename vector<value_type>::reverse_iterator;
+  using const_reverse_iterator =
+      typename vector<value_type>::const_reverse_iterator;
+
+private:
+  vector<value_type> _data;
+
+  template <typename Key> size_t _lowerIndex(const Key &k) const {
+    auto it = std::lower_bound(_data.begin(), _data.end(), k,
+                               [](const value_type &entry, const Key &key) {
+                                 return entry.first < key;
+                               });
+    return it - _data.begin();
+  }
+  template <typename Key> bool _matches(size_t i, const Key &k) const {
+    return i < _data.size() && !(k < _data[i].first);
+  }
+
+public:
+  size_t size() const { return _data.size(); }
+  bool empty() const { return _data.empty(); }
+  void clear() { _data.clear(); }
+  void reserve(size_t n) { _data.reserve(n); }
+
+  template <typename Key> iterator find(const Key &k) {
+    size_t i = _lowerIndex(k);
+    return _matches(i, k) ? _data.begin() + i : _data.end();
+  }
+  template <typename Key> const_iterator find(const Key &k) const {
+    size_t i = _lowerIndex(k);
+    return _matches(i, k) ? _data.begin() + i : _data.end();
+  }
+
+  V &operator[](const K &k) {
+    size_t i = _lowerIndex(k);
+    if (!_matches(i, k))
+      _data.emplace(_data.begin() + i, k, V());
+    return _data[i].second;
+  }
+
+  size_t erase(const K &k) {
+    size_t i = _lowerIndex(k);
+    if (!_matches(i, k))
+      return 0;
+    _data.erase(_data.begin() + i);
+    return 1;
+  }
+  iterator erase(const_iterator it) { return _data.erase(it); }
+
+  iterator begin() { return _data.begin(); }
+  iterator end() { return _data.end(); }
+  const_iterator begin() const { return _data.begin(); }
+  const_iterator end() const { return _data.end(); }
+  reverse_iterator rbegin() { return _data.rbegin(); }
+  reverse_iterator rend() { return _data.rend(); }
+  const_reverse_iterator rbegin() const { return _data.rbegin(); }
+  const_reverse_iterator rend() const { return _data.rend(); }
+};
+
+template <typename T> class FlatSet {
+public:
+  // Elements are read-only through iterators, as with std::set
+  using value_type = T;
+  using iterator = typename vector<T>::const_iterator;
+  using const_iterator = typename vector<T>::const_iterator;
+  using reverse_iterator = typename vector<T>::const_reverse_iterator;
+  using const_reverse_iterator = typename vector<T>::const_reverse_iterator;
+
+private:
+  vector<T> _data;
+
+  template <typename Key> size_t _lowerIndex(const Key &k) const {
+    auto it = std::lower_bound(_data.begin(), _data.end(), k,
+                               [](const T &elem, const Key &key) {
+                                 return elem < key;
+                               });
+    return it - _data.begin();
+  }
+  template <typename Key> bool _matches(size_t i, const Key &k) const {
+    return i < _data.size() && !(k < _data[i]);
+  }
+
+public:
+  size_t size() const { return _data.size(); }
+  bool empty() const { return _data.empty(); }
+  void clear() { _data.clear(); }
+  void reserve(size_t n) { _data.reserve(n); }
+
+  template <typename U> std::pair<iterator, bool> insert(U &&val) {
+    size_t i = _lowerIndex(val);
+    if (_matches(i, val))
+      return {_data.begin() + i, false};
+    return {_data.insert(_data.begin() + i, std::forward<U>(val)), true};
+  }
+  // Amortized O(1) when val belongs right before hint (e.g. appending
+  // in order at end()); otherwise falls back to a binary search
+  template <typename U> iterator insert(const_iterator hint, U &&val) {
+    if ((hint == _data.begin() || *(hint - 1) < val) &&
+        (hint == _data.end() || val < *hint))
+      return _data.insert(hint, std::forward<U>(val));
+    return insert(std::forward<U>(val)).first;
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return insert(T(std::forward<Args>(args)...));
+  }
+
+  template <typename Key> const_iterator find(const Key &k) const {
+    size_t i = _lowerIndex(k);
+    return _matches(i, k) ? _data.begin() + i : _data.end();
+  }
+
+  size_t erase(const T &val) {
+    size_t i = _lowerIndex(val);
+    if (!_matches(i, val))
+      return 0;
+    _data.erase(_data.begin() + i);
+    return 1;
+  }
+  iterator erase(const_iterator it) { return _data.erase(it); }
+
+  const_iterator begin() const { return _data.begin(); }
+  const_iterator end() const { return _data.end(); }
+  const_reverse_iterator rbegin() const { return _data.rbegin(); }
+  const_reverse_iterator rend() const { return _data.rend(); }
+};
+
+struct TreeBackend {
+  template <typename K, typename V>
+  using map_type = std::map<K, V, std::less<>>;
+  template <typename T> using set_type = std::set<T>;
+};
+
+struct FlatBackend {
+  template <typename K, typename V> using map_type = FlatMap<K, V>;
+  template <typename T> using set_type = FlatSet<T>;
+};
+
+#ifndef STANFORD_ORDERED_BACKEND
+#define STANFORD_ORDERED_BACKEND TreeBackend
+#endif
+using DefaultOrderedBackend = STANFORD_ORDERED_BACKEND;
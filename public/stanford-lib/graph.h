@@ -0,0 +1,392 @@
+#pragma once
+#include "common.h"
+#include "vector.h"
+#include "hashmap.h"
+#include <limits>
+#include <queue>
+
+// ============================================================
+// Graph - immutable graph in compressed sparse row form
+// ============================================================
+// Build a graph with a GraphBuilder, naming vertices as you go, then
+// freeze() it into a Graph:
+//   GraphBuilder<string> b(false); // undirected
+//   b.addEdge("Emily", "Ngoc");
+//   Graph<string> g = b.freeze();
+//   for (const auto &edge : g.neighbors(g.vertexId("Emily")))
+//     cout << g.vertexName(edge.to) << endl;
+// A Graph numbers its vertices 0..numVertices()-1 in the order they were
+// added. Each vertex's out-edges sit next to each other in one array,
+// in the order they were added. Traversals scan that array and keep their
+// bookkeeping in flat vectors indexed by vertex id, so visiting an edge
+// costs a few array reads rather than a Map<string, Set<string>> lookup.
+
+template <typename Name = string, typename Weight = double,
+          typename Checks = DefaultChecks>
+class Graph;
+
+template <typename Name, typename Weight>
+string _graphDebugString(bool directed, const vector<Name> &names,
+                         const vector<std::pair<int, int>> &ends,
+                         const vector<Weight> &weights) {
+  // Bigger graphs are summarized; a diagram of them would be unreadable
+  const int kMaxVertices = 40;
+  int shown = std::min((int)names.size(), kMaxVertices);
+  stringstream ss;
+  ss << "{\"__type\": \"Graph\", \"directed\": "
+     << (directed ? "true" : "false") << ", \"numVertices\": " << names.size()
+     << ", \"numEdges\": " << ends.size() << ", \"vertices\": [";
+  for (int v = 0; v < shown; v++)
+    ss << (v ? ", " : "") << _json_val(names[v]);
+  ss << "], \"edges\": [";
+  bool first = true;
+  for (size_t e = 0; e < ends.size(); e++) {
+    if (ends[e].first >= shown || ends[e].second >= shown)
+      continue;
+    ss << (first ? "" : ", ") << "[" << ends[e].first << ", "
+       << ends[e].second << ", " << _json_val(weights[e]) << "]";
+    first = false;
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+template <typename Name = string, typename Weight = double>
+class GraphBuilder {
+private:
+  bool _directed;
+  HashMap<Name, int> _ids;
+  vector<Name> _names;
+  vector<std::pair<int, int>> _ends; // (from, to) per edge
+  vector<Weight> _weights;
+
+  template <typename, typename, typename> friend class Graph;
+
+public:
+  explicit GraphBuilder(bool directed = true) : _directed(directed) {}
+
+  // Returns the vertex's id, adding the vertex if it is new
+  int addVertex(const Name &name) {
+    int count = _names.size();
+    int &id = _ids[name];
+    if (_ids.size() > count) {
+      id = count;
+      _names.push_back(name);
+    }
+    return id;
+  }
+  // Adds the missing endpoints too. In an undirected graph the edge can be
+  // followed both ways.
+  void addEdge(const Name &from, const Name &to, Weight weight = Weight(1)) {
+    int u = addVertex(from);
+    int v = addVertex(to);
+    _ends.push_back({u, v});
+    _weights.push_back(weight);
+  }
+  void reserve(int vertices, int edges) {
+    _ids.reserve(vertices);
+    _names.reserve(vertices);
+    _ends.reserve(edges);
+    _weights.reserve(edges);
+  }
+
+  bool isDirected() const { return _directed; }
+  int numVertices() const { return _names.size(); }
+  int numEdges() const { return _ends.size(); }
+  bool containsVertex(const Name &name) const {
+    return _ids.containsKey(name);
+  }
+
+  template <typename Checks = DefaultChecks>
+  Graph<Name, Weight, Checks> freeze() const {
+    return Graph<Name, Weight, Checks>(*this);
+  }
+
+  string toDebugString() const {
+    return _graphDebugString(_directed, _names, _ends, _weights);
+  }
+};
+
+template <typename Name, typename Weight, typename Checks> class Graph {
+public:
+  struct Edge {
+    int to;
+    Weight weight;
+  };
+  // The out-edges of one vertex, as a contiguous range
+  class EdgeRange {
+  private:
+    const Edge *_begin, *_end;
+
+  public:
+    EdgeRange(const Edge *begin, const Edge *end) : _begin(begin), _end(end) {}
+    const Edge *begin() const { return _begin; }
+    const Edge *end() const { return _end; }
+    int size() const { return _end - _begin; }
+    bool isEmpty() const { return _begin == _end; }
+    const Edge &operator[](int i) const { return _begin[i]; }
+  };
+  // Result of dijkstra(): distance[v] is infinite (or the largest Weight)
+  // and parent[v] is -1 when v can't be reached from the source
+  struct ShortestPaths {
+    Vector<Weight> distance;
+    Vector<int> parent;
+
+    bool reached(int v) const { return distance[v] != _unreached(); }
+    // Vertices from the source to v, or empty if v is unreachable
+    Vector<int> pathTo(int v) const {
+      Vector<int> path;
+      if (!reached(v))
+        return path;
+      for (; v >= 0; v = parent[v])
+        path.add(v);
+      std::reverse(path.begin(), path.end());
+      return path;
+    }
+  };
+
+private:
+  bool _directed = true;
+  // Vertex v's edges are _edges[_offsets[v]] up to _edges[_offsets[v + 1]]
+  vector<int> _offsets = {0};
+  vector<Edge> _edges;
+  vector<Name> _names;
+  HashMap<Name, int> _ids;
+  int _numEdges = 0;
+  bool _negative = false;
+
+  void _checkVertex(int v, const char *prefix) const {
+    if (Checks::check && (v < 0 || v >= numVertices()))
+      error(string("Graph::") + prefix + ": vertex id " + to_string(v) +
+            " is out of range");
+  }
+  static Weight _unreached() {
+    return std::numeric_limits<Weight>::has_infinity
+               ? std::numeric_limits<Weight>::infinity()
+               : std::numeric_limits<Weight>::max();
+  }
+
+public:
+  Graph() {}
+  // Lays the edges out grouped by source vertex with a counting sort,
+  // keeping each vertex's edges in the order they were added
+  explicit Graph(const GraphBuilder<Name, Weight> &builder)
+      : _directed(builder._directed), _names(builder._names),
+        _ids(builder._ids), _numEdges(builder._ends.size()) {
+    int n = _names.size();
+    _offsets.assign(n + 1, 0);
+    for (const auto &[u, v] : builder._ends) {
+      _offsets[u + 1]++;
+      if (!_directed && u != v)
+        _offsets[v + 1]++;
+    }
+    for (int i = 0; i < n; i++)
+      _offsets[i + 1] += _offsets[i];
+    _edges.resize(_offsets[n]);
+    vector<int> next(_offsets.begin(), _offsets.end() - 1);
+    for (size_t e = 0; e < builder._ends.size(); e++) {
+      auto [u, v] = builder._ends[e];
+      Weight w = builder._weights[e];
+      _edges[next[u]++] = {v, w};
+      if (!_directed && u != v)
+        _edges[next[v]++] = {u, w};
+      if (w < Weight(0))
+        _negative = true;
+    }
+  }
+
+  bool isDirected() const { return _directed; }
+  int numVertices() const { return _names.size(); }
+  // Each undirected edge counts once, although it is stored both ways
+  int numEdges() const { return _numEdges; }
+  bool isEmpty() const { return _names.empty(); }
+
+  bool containsVertex(const Name &name) const {
+    return _ids.containsKey(name);
+  }
+  int vertexId(const Name &name) const {
+    if (Checks::check && !_ids.containsKey(name))
+      error("Graph::vertexId: no vertex named " + _json_val(name));
+    return _ids.get(name);
+  }
+  const Name &vertexName(int v) const {
+    _checkVertex(v, "vertexName");
+    return _names[v];
+  }
+  // Names in id order
+  Vector<Name> vertexNames() const {
+    Vector<Name> names;
+    names.reserve(_names.size());
+    for (const Name &name : _names)
+      names.add(name);
+    return names;
+  }
+
+  EdgeRange neighbors(int v) const {
+    _checkVertex(v, "neighbors");
+    return EdgeRange(_edges.data() + _offsets[v],
+                     _edges.data() + _offsets[v + 1]);
+  }
+  int degree(int v) const {
+    _checkVertex(v, "degree");
+    return _offsets[v + 1] - _offsets[v];
+  }
+  bool hasEdge(int u, int v) const {
+    _checkVertex(v, "hasEdge");
+    for (const Edge &edge : neighbors(u)) {
+      if (edge.to == v)
+        return true;
+    }
+    return false;
+  }
+
+  // Calls visit(v, depth) for each vertex reachable from source, in
+  // breadth-first order; depth is the number of edges from the source
+  template <typename Visit> void bfs(int source, Visit visit) const {
+    _checkVertex(source, "bfs");
+    vector<int> depth(numVertices(), -1);
+    vector<int> queue;
+    queue.reserve(numVertices());
+    queue.push_back(source);
+    depth[source] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+      int u = queue[head];
+      visit(u, depth[u]);
+      for (const Edge &edge : neighbors(u)) {
+        if (depth[edge.to] < 0) {
+          depth[edge.to] = depth[u] + 1;
+          queue.push_back(edge.to);
+        }
+      }
+    }
+  }
+  // Calls visit(v) for each vertex reachable from source, in the preorder
+  // a recursive depth-first search would produce (without recursing, so
+  // long paths can't overflow the stack)
+  template <typename Visit> void dfs(int source, Visit visit) const {
+    _checkVertex(source, "dfs");
+    vector<bool> seen(numVertices());
+    vector<std::pair<int, int>> stack; // (vertex, next edge)
+    seen[source] = true;
+    visit(source);
+    stack.push_back({source, _offsets[source]});
+    while (!stack.empty()) {
+      auto &[u, next] = stack.back();
+      if (next == _offsets[u + 1]) {
+        stack.pop_back();
+        continue;
+      }
+      int v = _edges[next++].to;
+      if (!seen[v]) {
+        seen[v] = true;
+        visit(v);
+        stack.push_back({v, _offsets[v]});
+      }
+    }
+  }
+  Vector<int> bfsOrder(int source) const {
+    Vector<int> order;
+    bfs(source, [&](int v, int) { order.add(v); });
+    return order;
+  }
+  Vector<int> dfsOrder(int source) const {
+    Vector<int> order;
+    dfs(source, [&](int v) { order.add(v); });
+    return order;
+  }
+
+  ShortestPaths dijkstra(int source) const {
+    _checkVertex(source, "dijkstra");
+    if (_negative)
+      error("Graph::dijkstra: graph has a negative edge weight");
+    ShortestPaths paths;
+    paths.distance = Vector<Weight>(numVertices(), _unreached());
+    paths.parent = Vector<int>(numVertices(), -1);
+    // Entries are never updated in place; stale ones are skipped
+    using Entry = std::pair<Weight, int>;
+    vector<Entry> heap;
+    heap.reserve(numVertices());
+    std::priority_queue<Entry, vector<Entry>, std::greater<Entry>> frontier(
+        std::greater<Entry>(), std::move(heap));
+    paths.distance[source] = Weight(0);
+    frontier.push({Weight(0), source});
+    while (!frontier.empty()) {
+      auto [d, u] = frontier.top();
+      frontier.pop();
+      if (paths.distance[u] < d)
+        continue;
+      for (const Edge &edge : neighbors(u)) {
+        Weight candidate = d + edge.weight;
+        if (candidate < paths.distance[edge.to]) {
+          paths.distance[edge.to] = candidate;
+          paths.parent[edge.to] = u;
+          frontier.push({candidate, edge.to});
+        }
+      }
+    }
+    return paths;
+  }
+
+  // Every vertex, ordered so each edge goes from an earlier vertex to a
+  // later one (Kahn's algorithm; ties go to the lower id)
+  Vector<int> topologicalSort() const {
+    if (!_directed)
+      error("Graph::topologicalSort: graph is undirected");
+    int n = numVertices();
+    vector<int> indegree(n);
+    for (const Edge &edge : _edges)
+      indegree[edge.to]++;
+    std::priority_queue<int, vector<int>, std::greater<int>> ready;
+    for (int v = 0; v < n; v++) {
+      if (indegree[v] == 0)
+        ready.push(v);
+    }
+    Vector<int> order;
+    order.reserve(n);
+    while (!ready.empty()) {
+      int u = ready.top();
+      ready.pop();
+      order.add(u);
+      for (const Edge &edge : neighbors(u)) {
+        if (--indegree[edge.to] == 0)
+          ready.push(edge.to);
+      }
+    }
+    if (order.size() != n)
+      error("Graph::topologicalSort: graph has a cycle");
+    return order;
+  }
+
+  string toString() const {
+    stringstream ss;
+    ss << "{";
+    for (int u = 0; u < numVertices(); u++) {
+      ss << (u ? ", " : "") << _names[u] << ": {";
+      for (int e = _offsets[u]; e < _offsets[u + 1]; e++)
+        ss << (e > _offsets[u] ? ", " : "") << _names[_edges[e].to];
+      ss << "}";
+    }
+    ss << "}";
+    return ss.str();
+  }
+  string toDebugString() const {
+    // Undirected edges are drawn once, from the end with the lower id
+    vector<std::pair<int, int>> ends;
+    vector<Weight> weights;
+    for (int u = 0; u < numVertices(); u++) {
+      for (int e = _offsets[u]; e < _offsets[u + 1]; e++) {
+        if (_directed || u <= _edges[e].to) {
+          ends.push_back({u, _edges[e].to});
+          weights.push_back(_edges[e].weight);
+        }
+      }
+    }
+    return _graphDebugString(_directed, _names, ends, weights);
+  }
+};
+
+template <typename Name, typename Weight, typename Checks>
+ostream &operator<<(ostream &os, const Graph<Name, Weight, Checks> &g) {
+  os << g.toString();
+  return os;
+}
@@ -13,58 +13,113 @@ struct GridLocation {
 bool operator==(const GridLocation &a, const GridLocation &b) {
   return a.row == b.row && a.col == b.col;
 }
+bool operator!=(const GridLocation &a, const GridLocation &b) {
+  return !(a == b);
+}
+// Row-major order, matching Grid::locations()
+bool operator<(const GridLocation &a, const GridLocation &b) {
+  return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+bool operator<=(const GridLocation &a, const GridLocation &b) {
+  return !(b < a);
+}
+bool operator>(const GridLocation &a, const GridLocation &b) { return b < a; }
+bool operator>=(const GridLocation &a, const GridLocation &b) {
+  return !(a < b);
+}
 ostream &operator<<(ostream &os, const GridLocation &g) {
   os << g.toString();
   return os;
 }
+namespace std {
+template <> struct hash<GridLocation> {
+  size_t operator()(const GridLocation &loc) const {
+    // Pack both coordinates into one 64-bit key, then mix it
+    return (size_t)_hashMix((uint64_t)(uint32_t)loc.row << 32 |
+                            (uint32_t)loc.col);
+  }
+};
+} // namespace std
 
-// Forward declaration for GridLocationRange
+// The locations of a rectangle, generated one at a time as the range is
+// iterated, so a large grid's locations() costs no memory
 class GridLocationRange {
 private:
   int _startRow, _startCol, _endRow, _endCol;
   bool _rowMajor;
-  Vector<GridLocation> _locs;
-  void _buildLocs() {
-    _locs.clear();
-    if (_rowMajor) {
-      for (int r = _startRow; r <= _endRow; r++) {
-        for (int c = _startCol; c <= _endCol; c++) {
-          _locs.add(GridLocation(r, c));
-        }
-      }
-    } else {
-      for (int c = _startCol; c <= _endCol; c++) {
-        for (int r = _startRow; r <= _endRow; r++) {
-          _locs.add(GridLocation(r, c));
-        }
+
+public:
+  class iterator {
+  private:
+    const GridLocationRange *_range;
+    GridLocation _loc;
+    // Handed out by operator* so that loops written for the old
+    // Vector<GridLocation> (for (GridLocation &loc : ...)) still compile;
+    // changing it does not disturb the iteration
+    mutable GridLocation _value;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = GridLocation;
+    using difference_type = std::ptrdiff_t;
+    using pointer = GridLocation *;
+    using reference = GridLocation &;
+
+    iterator(const GridLocationRange *range, GridLocation loc)
+        : _range(range), _loc(loc) {}
+    GridLocation &operator*() const {
+      _value = _loc;
+      return _value;
+    }
+    GridLocation *operator->() const { return &**this; }
+    iterator &operator++() {
+      const GridLocationRange &r = *_range;
+      if (r._rowMajor && ++_loc.col > r._endCol) {
+        _loc.col = r._startCol;
+        _loc.row++;
+      } else if (!r._rowMajor && ++_loc.row > r._endRow) {
+        _loc.row = r._startRow;
+        _loc.col++;
       }
+      return *this;
     }
-  }
+    iterator operator++(int) {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const iterator &other) const { return _loc == other._loc; }
+    bool operator!=(const iterator &other) const { return _loc != other._loc; }
+  };
+  using const_iterator = iterator;
 
-public:
   GridLocationRange(int startRow, int startCol, int endRow, int endCol,
                     bool rowMajor = true)
       : _startRow(startRow), _startCol(startCol), _endRow(endRow),
-        _endCol(endCol), _rowMajor(rowMajor) {
-    _buildLocs();
-  }
+        _endCol(endCol), _rowMajor(rowMajor) {}
   GridLocationRange()
       : _startRow(0), _startCol(0), _endRow(-1), _endCol(-1), _rowMajor(true) {}
-  typename vector<GridLocation>::iterator begin() { return _locs.begin(); }
-  typename vector<GridLocation>::iterator end() { return _locs.end(); }
-  typename vector<GridLocation>::const_iterator begin() const {
-    return _locs.begin();
+  bool isEmpty() const { return _endRow < _startRow || _endCol < _startCol; }
+  iterator begin() const {
+    return isEmpty() ? end() : iterator(this, {_startRow, _startCol});
   }
-  typename vector<GridLocation>::const_iterator end() const {
-    return _locs.end();
+  iterator end() const {
+    return _rowMajor ? iterator(this, {_endRow + 1, _startCol})
+                     : iterator(this, {_startRow, _endCol + 1});
   }
 };
 
-template <typename T> class Grid {
+template <typename T, typename Checks = DefaultChecks> class Grid {
 private:
   int _r, _c;
-  vector<vector<T>> _g;
+  _Shareable<vector<vector<T>>> _g;
+
+  const vector<vector<T>> &_read() const { return _g.read(); }
+  vector<vector<T>> &_write() { return _g.write(); }
+
   void _checkIndexes(int row, int col, const char *prefix) const {
+    if (!Checks::check)
+      return;
     if (row < 0 || row >= _r || col < 0 || col >= _c) {
       stringstream ss;
       ss << "Grid::" << prefix << ": (" << row << ", " << col
@@ -87,12 +142,13 @@ public:
   Grid(std::initializer_list<std::initializer_list<T>> list) {
     _r = list.size();
     _c = (_r > 0) ? list.begin()->size() : 0;
-    _g.resize(_r);
+    vector<vector<T>> &g = _write();
+    g.resize(_r);
     int i = 0;
     for (const auto &row : list) {
       if ((int)row.size() != _c)
         error("Grid::constructor: initializer list is not rectangular");
-      _g[i] = row;
+      g[i] = row;
       i++;
     }
   }
@@ -106,8 +162,8 @@ public:
     }
   }
 
-  bool equals(const Grid<T> &grid2) const {
-    if (this == &grid2)
+  bool equals(const Grid &grid2) const {
+    if (_g.buffer() == grid2._g.buffer())
       return true;
     if (_r != grid2._r || _c != grid2._c)
       return false;
@@ -138,12 +194,13 @@ public:
     if (r == _r && c == _c && retain)
       return;
 
-    vector<vector<T>> oldG = _g;
+    vector<vector<T>> oldG = _read();
     int oldR = _r, oldC = _c;
     _r = r;
     _c = c;
-    _g.resize(r);
-    for (auto &row : _g)
+    vector<vector<T>> &g = _write();
+    g.resize(r);
+    for (auto &row : g)
       row.resize(c, T());
 
     if (retain) {
@@ -151,7 +208,7 @@ public:
       int minC = (oldC < c) ? oldC : c;
       for (int row = 0; row < minR; row++) {
         for (int col = 0; col < minC; col++) {
-          _g[row][col] = oldG[row][col];
+          g[row][col] = oldG[row][col];
         }
       }
     }
@@ -173,23 +230,24 @@ public:
     return GridLocationRange(0, 0, _r - 1, _c - 1, rowMajor);
   }
 
-  void mapAll(std::function<void(const T &)> fn) const {
-    for (int i = 0; i < _r; i++) {
-      for (int j = 0; j < _c; j++) {
-        fn(get(i, j));
-      }
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (const vector<T> &row : _read()) {
+      for (const T &value : row)
+        fn(value);
     }
   }
+  // The rows, top to bottom: for (const vector<T> &row : grid.rows())
+  const vector<vector<T>> &rows() const { return _read(); }
 
   const T &get(int r, int c) const {
     _checkIndexes(r, c, "get");
-    return _g.at(r).at(c);
+    return _checked_at<Checks>(_checked_at<Checks>(_read(), r), c);
   }
   const T &get(const GridLocation &loc) const { return get(loc.row, loc.col); }
 
   void set(int r, int c, const T &val) {
     _checkIndexes(r, c, "set");
-    _g.at(r).at(c) = val;
+    _checked_at<Checks>(_checked_at<Checks>(_write(), r), c) = val;
   }
   void set(const GridLocation &loc, const T &val) {
     set(loc.row, loc.col, val);
@@ -203,7 +261,7 @@ public:
     for (int i = 0; i < _r; i++) {
       ss << "{";
       for (int j = 0; j < _c; j++)
-        ss << _g[i][j] << (j < _c - 1 ? ", " : "");
+        ss << _read()[i][j] << (j < _c - 1 ? ", " : "");
       ss << "}" << (i < _r - 1 ? ", " : "");
     }
     ss << "}";
@@ -222,7 +280,7 @@ public:
       for (int j = 0; j < _c; j++) {
         if (j > 0)
           ss << colSeparator;
-        ss << _g[i][j];
+        ss << _read()[i][j];
       }
       ss << rowEnd;
     }
@@ -237,57 +295,70 @@ public:
     for (int i = 0; i < _r; i++) {
       ss << "[";
       for (int j = 0; j < _c; j++)
-        ss << _json_val(_g[i][j]) << (j < _c - 1 ? ", " : "");
+        ss << _json_val(_read()[i][j]) << (j < _c - 1 ? ", " : "");
       ss << "]" << (i < _r - 1 ? ", " : "");
     }
     ss << "]}";
-    return ss.str();
+    return _debug_shared(_g, ss.str());
   }
 
   vector<T> &operator[](int r) {
-    if (r < 0 || r >= _r)
+    if (Checks::check && (r < 0 || r >= _r))
       error("Grid::operator[]: row index out of range");
-    return _g[r];
+    return _write()[r];
   }
   const vector<T> &operator[](int r) const {
-    if (r < 0 || r >= _r)
+    if (Checks::check && (r < 0 || r >= _r))
       error("Grid::operator[]: row index out of range");
-    return _g[r];
+    return _read()[r];
   }
   T &operator[](const GridLocation &loc) {
     _checkIndexes(loc.row, loc.col, "operator[]");
-    return _g[loc.row][loc.col];
+    return _write()[loc.row][loc.col];
   }
   const T &operator[](const GridLocation &loc) const {
     _checkIndexes(loc.row, loc.col, "operator[]");
-    return _g[loc.row][loc.col];
+    return _read()[loc.row][loc.col];
   }
 
-  bool operator==(const Grid<T> &grid2) const { return equals(grid2); }
-  bool operator!=(const Grid<T> &grid2) const { return !equals(grid2); }
-  bool operator<(const Grid<T> &grid2) const {
+  bool operator==(const Grid &grid2) const { return equals(grid2); }
+  bool operator!=(const Grid &grid2) const { return !equals(grid2); }
+  bool operator<(const Grid &grid2) const {
     if (_r != grid2._r)
       return _r < grid2._r;
     if (_c != grid2._c)
       return _c < grid2._c;
+    const vector<vector<T>> &g1 = _read(), &g2 = grid2._read();
     for (int i = 0; i < _r; i++) {
       for (int j = 0; j < _c; j++) {
-        if (_g[i][j] < grid2._g[i][j])
+        if (g1[i][j] < g2[i][j])
           return true;
-        if (grid2._g[i][j] < _g[i][j])
+        if (g2[i][j] < g1[i][j])
           return false;
       }
     }
     return false;
   }
-  bool operator<=(const Grid<T> &grid2) const {
+  bool operator<=(const Grid &grid2) const {
     return *this < grid2 || *this == grid2;
   }
-  bool operator>(const Grid<T> &grid2) const { return grid2 < *this; }
-  bool operator>=(const Grid<T> &grid2) const { return grid2 <= *this; }
+  bool operator>(const Grid &grid2) const { return grid2 < *this; }
+  bool operator>=(const Grid &grid2) const { return grid2 <= *this; }
 };
 
-template <typename T> ostream &operator<<(ostream &os, const Grid<T> &g) {
+template <typename T, typename Checks>
+ostream &operator<<(ostream &os, const Grid<T, Checks> &g) {
   os << g.toString();
   return os;
 }
+
+namespace std {
+template <typename T, typename Checks> struct hash<Grid<T, Checks>> {
+  size_t operator()(const Grid<T, Checks> &g) const {
+    size_t seed = _hashCombine(g.numRows(), g.numCols());
+    for (int r = 0; r < g.numRows(); r++)
+      seed = _hashRange(g[r].begin(), g[r].end(), seed);
+    return seed;
+  }
+};
+} // namespace std
@@ -1,33 +1,61 @@
 #pragma once
 #include "common.h"
-#include <unordered_map>
+#include "flathash.h"
 #include <functional>
 
 template <typename KeyType, typename ValueType> class HashMap {
 private:
-  std::unordered_map<KeyType, ValueType> _map;
+  // A const key, as in std::unordered_map: iteration hands out references
+  // to the stored entries, and rewriting a key would misplace it. Stable
+  // storage never assigns entries, so the const member is no obstacle
+  using _Entry = std::pair<const KeyType, ValueType>;
+  struct _KeyOf {
+    const KeyType &operator()(const _Entry &entry) const { return entry.first; }
+  };
+  // Stable: references to values survive inserts that grow the table
+  using _Table =
+      FlatHashTable<_Entry, KeyType, _KeyOf, std::hash<KeyType>, true>;
+  _Table _map;
+
+  ValueType &_findOrInsert(const KeyType &key) {
+    return _map
+        .tryEmplace(key, std::piecewise_construct, std::forward_as_tuple(key),
+                    std::forward_as_tuple())
+        .first->second;
+  }
 
 public:
   HashMap() {}
-  HashMap(std::initializer_list<std::pair<const KeyType, ValueType>> list)
-      : _map(list) {}
+  HashMap(std::initializer_list<std::pair<const KeyType, ValueType>> list) {
+    _map.reserve(list.size());
+    for (const auto &entry : list)
+      _findOrInsert(entry.first) = entry.second;
+  }
 
   int size() const { return _map.size(); }
   bool isEmpty() const { return _map.empty(); }
   void clear() { _map.clear(); }
+  // Makes room for n entries; the table grows once it is 7/8 full
+  void reserve(int n) {
+    if (n > 0)
+      _map.reserve(n);
+  }
 
-  void put(const KeyType &key, const ValueType &value) { _map[key] = value; }
+  void put(const KeyType &key, const ValueType &value) {
+    _findOrInsert(key) = value;
+  }
+  void put(const KeyType &key, ValueType &&value) {
+    _findOrInsert(key) = std::move(value);
+  }
 
-  ValueType get(const KeyType &key) const {
+  const ValueType &get(const KeyType &key) const {
     auto it = _map.find(key);
     if (it == _map.end())
       error("HashMap::get: key not found");
     return it->second;
   }
 
-  bool containsKey(const KeyType &key) const {
-    return _map.find(key) != _map.end();
-  }
+  bool containsKey(const KeyType &key) const { return _map.contains(key); }
 
   void remove(const KeyType &key) {
     auto it = _map.find(key);
@@ -36,8 +64,11 @@ public:
     _map.erase(it);
   }
 
+  // keys() and values() traverse the table in the same order, so
+  // keys()[i] always maps to values()[i]
   Vector<KeyType> keys() const {
     Vector<KeyType> result;
+    result.reserve(size());
     for (const auto &pair : _map)
       result.add(pair.first);
     return result;
@@ -45,28 +76,31 @@ public:
 
   Vector<ValueType> values() const {
     Vector<ValueType> result;
+    result.reserve(size());
     for (const auto &pair : _map)
       result.add(pair.second);
     return result;
   }
 
   bool equals(const HashMap<KeyType, ValueType> &other) const {
+    if (this == &other)
+      return true;
     if (size() != other.size())
       return false;
     for (const auto &pair : _map) {
-      if (!other.containsKey(pair.first) ||
-          other.get(pair.first) != pair.second)
+      auto it = other._map.find(pair.first);
+      if (it == other._map.end() || !(it->second == pair.second))
         return false;
     }
     return true;
   }
 
-  void mapAll(std::function<void(const KeyType &, const ValueType &)> fn) const {
+  template <typename Fn> void mapAll(Fn fn) const {
     for (const auto &pair : _map)
       fn(pair.first, pair.second);
   }
 
-  ValueType &operator[](const KeyType &key) { return _map[key]; }
+  ValueType &operator[](const KeyType &key) { return _findOrInsert(key); }
 
   const ValueType &operator[](const KeyType &key) const {
     auto it = _map.find(key);
@@ -111,19 +145,10 @@ public:
     return ss.str();
   }
 
-  typename std::unordered_map<KeyType, ValueType>::iterator begin() {
-    return _map.begin();
-  }
-  typename std::unordered_map<KeyType, ValueType>::iterator end() {
-    return _map.end();
-  }
-  typename std::unordered_map<KeyType, ValueType>::const_iterator
-  begin() const {
-    return _map.begin();
-  }
-  typename std::unordered_map<KeyType, ValueType>::const_iterator end() const {
-    return _map.end();
-  }
+  typename _Table::iterator begin() { return _map.begin(); }
+  typename _Table::iterator end() { return _map.end(); }
+  typename _Table::const_iterator begin() const { return _map.begin(); }
+  typename _Table::const_iterator end() const { return _map.end(); }
 };
 
 template <typename KeyType, typename ValueType>
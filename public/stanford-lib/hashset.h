@@ -1,25 +1,39 @@
 #pragma once
 #include "common.h"
-#include <unordered_set>
+#include "flathash.h"
 #include <functional>
 
 template <typename ValueType> class HashSet {
 private:
-  std::unordered_set<ValueType> _set;
+  struct _KeyOf {
+    const ValueType &operator()(const ValueType &value) const { return value; }
+  };
+  // Stable: references to elements survive inserts that grow the table
+  using _Table =
+      FlatHashTable<ValueType, ValueType, _KeyOf, std::hash<ValueType>, true>;
+  _Table _set;
 
 public:
   HashSet() {}
-  HashSet(std::initializer_list<ValueType> list) : _set(list) {}
+  HashSet(std::initializer_list<ValueType> list) {
+    _set.reserve(list.size());
+    for (const auto &value : list)
+      add(value);
+  }
 
   int size() const { return _set.size(); }
   bool isEmpty() const { return _set.empty(); }
   void clear() { _set.clear(); }
+  // Makes room for n values; the table grows once it is 7/8 full
+  void reserve(int n) {
+    if (n > 0)
+      _set.reserve(n);
+  }
 
-  void add(const ValueType &value) { _set.insert(value); }
+  void add(const ValueType &value) { _set.tryEmplace(value, value); }
+  void add(ValueType &&value) { _set.tryEmplace(value, std::move(value)); }
 
-  bool contains(const ValueType &value) const {
-    return _set.find(value) != _set.end();
-  }
+  bool contains(const ValueType &value) const { return _set.contains(value); }
 
   void remove(const ValueType &value) {
     auto it = _set.find(value);
@@ -35,10 +49,12 @@ public:
   }
 
   bool equals(const HashSet<ValueType> &other) const {
-    return _set == other._set;
+    return size() == other.size() && isSubsetOf(other);
   }
 
   bool isSubsetOf(const HashSet<ValueType> &other) const {
+    if (size() > other.size())
+      return false;
     for (const auto &elem : _set) {
       if (!other.contains(elem))
         return false;
@@ -50,25 +66,37 @@ public:
     return other.isSubsetOf(*this);
   }
 
-  void mapAll(std::function<void(const ValueType &)> fn) const {
+  template <typename Fn> void mapAll(Fn fn) const {
     for (const auto &elem : _set)
       fn(elem);
   }
 
-  HashSet<ValueType> operator+(const HashSet<ValueType> &other) const {
-    HashSet<ValueType> result = *this;
-    for (const auto &elem : other._set)
-      result.add(elem);
-    return result;
+  // Operators with a temporary left operand (as in a + b + c) update it
+  // in place instead of copying it
+  HashSet<ValueType> operator+(const HashSet<ValueType> &other) const & {
+    const HashSet<ValueType> &big = size() >= other.size() ? *this : other;
+    const HashSet<ValueType> &small = size() >= other.size() ? other : *this;
+    HashSet<ValueType> result = big;
+    return std::move(result += small);
+  }
+  HashSet<ValueType> operator+(const HashSet<ValueType> &other) && {
+    return std::move(*this += other);
   }
 
-  HashSet<ValueType> operator+(const ValueType &value) const {
+  HashSet<ValueType> operator+(const ValueType &value) const & {
     HashSet<ValueType> result = *this;
     result.add(value);
     return result;
   }
+  HashSet<ValueType> operator+(const ValueType &value) && {
+    add(value);
+    return std::move(*this);
+  }
 
   HashSet<ValueType> &operator+=(const HashSet<ValueType> &other) {
+    if (this == &other)
+      return *this;
+    _set.reserve(size() + other.size());
     for (const auto &elem : other._set)
       add(elem);
     return *this;
@@ -79,16 +107,32 @@ public:
     return *this;
   }
 
-  HashSet<ValueType> operator*(const HashSet<ValueType> &other) const {
+  // Intersection only ever needs to look at the smaller operand
+  HashSet<ValueType> operator*(const HashSet<ValueType> &other) const & {
+    const HashSet<ValueType> &big = size() >= other.size() ? *this : other;
+    const HashSet<ValueType> &small = size() >= other.size() ? other : *this;
     HashSet<ValueType> result;
-    for (const auto &elem : _set) {
-      if (other.contains(elem))
+    for (const auto &elem : small._set) {
+      if (big.contains(elem))
         result.add(elem);
     }
     return result;
   }
+  HashSet<ValueType> operator*(const HashSet<ValueType> &other) && {
+    return std::move(*this *= other);
+  }
+
+  HashSet<ValueType> &operator*=(const HashSet<ValueType> &other) {
+    for (auto it = _set.begin(); it != _set.end();) {
+      if (other.contains(*it))
+        ++it;
+      else
+        it = _set.erase(it);
+    }
+    return *this;
+  }
 
-  HashSet<ValueType> operator-(const HashSet<ValueType> &other) const {
+  HashSet<ValueType> operator-(const HashSet<ValueType> &other) const & {
     HashSet<ValueType> result;
     for (const auto &elem : _set) {
       if (!other.contains(elem))
@@ -96,12 +140,23 @@ public:
     }
     return result;
   }
+  HashSet<ValueType> operator-(const HashSet<ValueType> &other) && {
+    return std::move(*this -= other);
+  }
 
   HashSet<ValueType> &operator-=(const HashSet<ValueType> &other) {
-    for (const auto &elem : other._set) {
-      auto it = _set.find(elem);
-      if (it != _set.end())
-        _set.erase(it);
+    if (this == &other) {
+      clear();
+    } else if (other.size() < size()) {
+      for (const auto &elem : other._set)
+        _set.erase(elem);
+    } else {
+      for (auto it = _set.begin(); it != _set.end();) {
+        if (other.contains(*it))
+          it = _set.erase(it);
+        else
+          ++it;
+      }
     }
     return *this;
   }
@@ -142,16 +197,8 @@ public:
     return ss.str();
   }
 
-  typename std::unordered_set<ValueType>::iterator begin() {
-    return _set.begin();
-  }
-  typename std::unordered_set<ValueType>::iterator end() { return _set.end(); }
-  typename std::unordered_set<ValueType>::const_iterator begin() const {
-    return _set.begin();
-  }
-  typename std::unordered_set<ValueType>::const_iterator end() const {
-    return _set.end();
-  }
+  typename _Table::const_iterator begin() const { return _set.begin(); }
+  typename _Table::const_iterator end() const { return _set.end(); }
 };
 
 template <typename ValueType>
@@ -0,0 +1,383 @@
+#pragma once
+#include "common.h"
+#include "strlib.h"
+#include <fstream>
+
+// ============================================================
+// Lexicon - word list stored as a DAWG
+// ============================================================
+// The words are kept as a minimal directed acyclic word graph: a trie
+// whose identical subtrees (shared suffixes such as "-ing", "-tion") are
+// merged. The graph lives in four flat arrays, so a 100k-word dictionary
+// takes a small fraction of the memory of a Set<string> holding it, and
+// contains/containsPrefix cost O(length of the word), independent of the
+// number of words.
+//
+// Words are case-insensitive (stored in lowercase), as in the Stanford
+// library. Words added one at a time are collected in a small sorted
+// side set and merged into the graph in batches.
+
+class Lexicon {
+private:
+  // Node n's outgoing edges are [_edgeStart[n], _edgeStart[n + 1]),
+  // sorted by label as unsigned bytes, the order std::string sorts in.
+  // _root is -1 until the graph is first built.
+  //
+  // _pending holds words not merged into the graph yet. Iteration merges
+  // them first, so the graph and _pending are mutable to keep begin()
+  // const.
+  mutable vector<int> _edgeStart;
+  mutable vector<unsigned char> _edgeLabel;
+  mutable vector<int> _edgeTarget;
+  mutable vector<bool> _final;
+  mutable int _root = -1;
+  mutable int _graphWords = 0;
+  mutable std::set<string> _pending;
+
+  static char _lower(char ch) { return std::tolower((unsigned char)ch); }
+
+  // Follows text from the root; -1 if it falls off the graph
+  int _walk(const string &text) const {
+    if (_root < 0)
+      return -1;
+    int node = _root;
+    for (char c : text) {
+      unsigned char ch = _lower(c);
+      int lo = _edgeStart[node], hi = _edgeStart[node + 1];
+      while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (_edgeLabel[mid] < ch)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      if (lo == _edgeStart[node + 1] || _edgeLabel[lo] != ch)
+        return -1;
+      node = _edgeTarget[lo];
+    }
+    return node;
+  }
+
+  // Builds the minimal graph from sorted, unique words (Daciuk et al.'s
+  // incremental algorithm). Only the path of the previous word is still
+  // mutable; each node leaving it is either replaced by an identical node
+  // already in the graph or appended to the flat arrays, so the graph is
+  // written in post-order and the root comes last.
+  template <typename It> void _build(It begin, It end) const {
+    struct PathNode {
+      bool final = false;
+      vector<std::pair<unsigned char, int>> edges;
+    };
+    vector<PathNode> path(1);
+    // Open-addressing set of node ids, keyed by (final, edges)
+    vector<int> registry(1024, -1);
+    int registered = 0;
+
+    _edgeStart.assign(1, 0);
+    _edgeLabel.clear();
+    _edgeTarget.clear();
+    _final.clear();
+
+    // edge(i) returns the i-th (label, target) pair
+    auto hashOf = [](bool final, int edges, auto edge) {
+      size_t h = final;
+      for (int i = 0; i < edges; i++) {
+        auto [label, target] = edge(i);
+        h = _hashCombine(h, (uint64_t)(unsigned char)label << 32 | target);
+      }
+      return h;
+    };
+    auto hashNode = [&](int id) {
+      int first = _edgeStart[id];
+      return hashOf(_final[id], _edgeStart[id + 1] - first, [&](int i) {
+        return std::make_pair(_edgeLabel[first + i], _edgeTarget[first + i]);
+      });
+    };
+    auto sameAs = [&](int id, const PathNode &n) {
+      int first = _edgeStart[id];
+      if (_final[id] != n.final ||
+          _edgeStart[id + 1] - first != (int)n.edges.size())
+        return false;
+      for (size_t i = 0; i < n.edges.size(); i++) {
+        if (_edgeLabel[first + i] != n.edges[i].first ||
+            _edgeTarget[first + i] != n.edges[i].second)
+          return false;
+      }
+      return true;
+    };
+    auto append = [&](const PathNode &n) {
+      _final.push_back(n.final);
+      for (const auto &[label, target] : n.edges) {
+        _edgeLabel.push_back(label);
+        _edgeTarget.push_back(target);
+      }
+      _edgeStart.push_back(_edgeLabel.size());
+      return (int)_final.size() - 1;
+    };
+    auto freeze = [&](const PathNode &n) {
+      size_t mask = registry.size() - 1;
+      size_t slot = hashOf(n.final, n.edges.size(),
+                           [&](int i) { return n.edges[i]; }) &
+                    mask;
+      for (; registry[slot] >= 0; slot = (slot + 1) & mask) {
+        if (sameAs(registry[slot], n))
+          return registry[slot];
+      }
+      int id = append(n);
+      registry[slot] = id;
+      if (++registered * 2 > (int)registry.size()) {
+        registry.assign(registry.size() * 2, -1);
+        mask = registry.size() - 1;
+        for (int r = 0; r < (int)_final.size(); r++) {
+          size_t s = hashNode(r) & mask;
+          while (registry[s] >= 0)
+            s = (s + 1) & mask;
+          registry[s] = r;
+        }
+      }
+      return id;
+    };
+    // Freezes the previous word's path below depth
+    auto minimize = [&](size_t depth, size_t from) {
+      for (size_t i = from; i > depth; i--)
+        path[i - 1].edges.back().second = freeze(path[i]);
+    };
+
+    string previous;
+    int count = 0;
+    for (It it = begin; it != end; ++it) {
+      const string &word = *it;
+      size_t common = 0;
+      while (common < word.size() && common < previous.size() &&
+             word[common] == previous[common])
+        common++;
+      minimize(common, previous.size());
+      if (path.size() < word.size() + 1)
+        path.resize(word.size() + 1);
+      for (size_t i = common; i < word.size(); i++) {
+        path[i].edges.push_back({(unsigned char)word[i], -1});
+        path[i + 1].final = false;
+        path[i + 1].edges.clear();
+      }
+      path[word.size()].final = true;
+      previous = word;
+      count++;
+    }
+    minimize(0, previous.size());
+    _root = append(path[0]);
+    _edgeLabel.shrink_to_fit();
+    _edgeTarget.shrink_to_fit();
+    _graphWords = count;
+  }
+
+  // Merges sorted, unique lowercase words with the graph's words
+  void _rebuildWith(const vector<string> &words) const {
+    if (_graphWords == 0) {
+      _build(words.begin(), words.end());
+      return;
+    }
+    vector<string> merged;
+    merged.reserve(_graphWords + words.size());
+    std::set_union(_graphBegin(), _graphEnd(), words.begin(), words.end(),
+                   std::back_inserter(merged));
+    _build(merged.begin(), merged.end());
+  }
+  void _flush() const {
+    if (_pending.empty())
+      return;
+    vector<string> words(_pending.begin(), _pending.end());
+    _pending.clear();
+    _rebuildWith(words);
+  }
+
+public:
+  // Visits the graph's words in order (depth-first, edges by label)
+  class iterator {
+  private:
+    const Lexicon *_lex = nullptr;
+    vector<std::pair<int, int>> _stack; // (node, next edge)
+    string _word;
+
+    void _advance() {
+      while (!_stack.empty()) {
+        int node = _stack.back().first;
+        int edge = _stack.back().second;
+        if (edge < _lex->_edgeStart[node + 1]) {
+          _stack.back().second++;
+          int child = _lex->_edgeTarget[edge];
+          _word.push_back(_lex->_edgeLabel[edge]);
+          _stack.push_back({child, _lex->_edgeStart[child]});
+          if (_lex->_final[child])
+            return;
+        } else {
+          _stack.pop_back();
+          if (!_stack.empty())
+            _word.pop_back();
+        }
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = string;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const string *;
+    using reference = const string &;
+
+    iterator() {}
+    iterator(const Lexicon *lex) : _lex(lex) {
+      if (lex->_root < 0)
+        return;
+      _stack.push_back({lex->_root, lex->_edgeStart[lex->_root]});
+      _advance();
+    }
+    const string &operator*() const { return _word; }
+    const string *operator->() const { return &_word; }
+    iterator &operator++() {
+      _advance();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator old = *this;
+      _advance();
+      return old;
+    }
+    bool operator==(const iterator &other) const {
+      return _stack.empty() == other._stack.empty() &&
+             (_stack.empty() || _word == other._word);
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+  using const_iterator = iterator;
+
+private:
+  iterator _graphBegin() const { return iterator(this); }
+  iterator _graphEnd() const { return iterator(); }
+
+public:
+  Lexicon() {}
+  Lexicon(std::initializer_list<string> words) {
+    for (const auto &word : words)
+      add(word);
+  }
+  explicit Lexicon(const string &filename) { addWordsFromFile(filename); }
+
+  int size() const { return _graphWords + _pending.size(); }
+  bool isEmpty() const { return size() == 0; }
+  void clear() {
+    _edgeStart.clear();
+    _edgeLabel.clear();
+    _edgeTarget.clear();
+    _final.clear();
+    _root = -1;
+    _graphWords = 0;
+    _pending.clear();
+  }
+
+  void add(const string &word) {
+    if (word.empty() || contains(word))
+      return;
+    _pending.insert(toLowerCase(word));
+    // Merge in batches so each rebuild is paid for by many adds
+    if ((int)_pending.size() > std::max(1024, _graphWords / 4))
+      _flush();
+  }
+
+  // Adds every non-blank line of the file (one word per line). Sorting
+  // the words once and building the graph in one pass keeps loading a
+  // large dictionary fast.
+  void addWordsFromFile(const string &filename) {
+    std::ifstream in(filename);
+    if (!in)
+      error("Lexicon::addWordsFromFile: Couldn't open lexicon file " +
+            filename);
+    vector<string> words;
+    string line;
+    while (std::getline(in, line)) {
+      size_t first = line.find_first_not_of(" \t\r\n");
+      if (first == string::npos)
+        continue;
+      size_t last = line.find_last_not_of(" \t\r\n");
+      words.emplace_back(line, first, last - first + 1);
+      for (char &ch : words.back())
+        ch = _lower(ch);
+    }
+    words.insert(words.end(), _pending.begin(), _pending.end());
+    _pending.clear();
+    // Dictionary files are usually sorted already
+    if (!std::is_sorted(words.begin(), words.end()))
+      std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    _rebuildWith(words);
+  }
+
+  bool contains(const string &word) const {
+    if (word.empty())
+      return false;
+    int node = _walk(word);
+    if (node >= 0 && _final[node])
+      return true;
+    return !_pending.empty() && _pending.count(toLowerCase(word));
+  }
+
+  bool containsPrefix(const string &prefix) const {
+    if (prefix.empty())
+      return !isEmpty();
+    if (_walk(prefix) >= 0)
+      return true;
+    if (_pending.empty())
+      return false;
+    string lower = toLowerCase(prefix);
+    auto it = _pending.lower_bound(lower);
+    return it != _pending.end() && it->compare(0, lower.size(), lower) == 0;
+  }
+
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (const string &word : *this)
+      fn(word);
+  }
+
+  iterator begin() const {
+    _flush();
+    return _graphBegin();
+  }
+  iterator end() const { return _graphEnd(); }
+
+  bool equals(const Lexicon &lex2) const {
+    return size() == lex2.size() &&
+           std::equal(begin(), end(), lex2.begin(), lex2.end());
+  }
+  bool operator==(const Lexicon &lex2) const { return equals(lex2); }
+  bool operator!=(const Lexicon &lex2) const { return !equals(lex2); }
+
+  string toString() const {
+    stringstream ss;
+    ss << "{";
+    bool first = true;
+    for (const string &word : *this) {
+      if (!first)
+        ss << ", ";
+      first = false;
+      ss << "\"" << word << "\"";
+    }
+    ss << "}";
+    return ss.str();
+  }
+  // A summary instead of every word: dictionaries run to 100k+ words
+  string toDebugString() const {
+    stringstream ss;
+    ss << "{\"__type\": \"Lexicon\", \"size\": " << size()
+       << ", \"nodes\": " << _final.size()
+       << ", \"edges\": " << _edgeLabel.size() << ", \"first\": [";
+    int shown = 0;
+    for (auto it = begin(); it != end() && shown < 10; ++it, shown++)
+      ss << (shown ? ", " : "") << _json_val(*it);
+    ss << "]}";
+    return ss.str();
+  }
+};
+
+ostream &operator<<(ostream &os, const Lexicon &lex) {
+  os << lex.toString();
+  return os;
+}
@@ -1,36 +1,95 @@
 #pragma once
 #include "common.h"
+#include "flatstorage.h"
 #include "vector.h"
 
-template <typename K, typename V> class Map {
+template <typename K, typename V, typename Backend = DefaultOrderedBackend>
+class Map {
 private:
-  map<K, V> _m;
+  // Both backends compare keys transparently, so lookups accept anything
+  // comparable with K (e.g. a string_view or string literal into a
+  // Map<string, ...>) without building a temporary key.
+  using _Storage = typename Backend::template map_type<K, V>;
+  _Shareable<_Storage> _m;
+
+  const _Storage &_read() const { return _m.read(); }
+  _Storage &_write() { return _m.write(); }
+
+  // Enables the heterogeneous lookup overloads for key-like types other
+  // than K itself
+  template <typename Key>
+  using _if_key_like = std::enable_if_t<
+      !std::is_same_v<std::decay_t<Key>, K> &&
+      std::is_convertible_v<decltype(std::declval<const K &>() <
+                                     std::declval<const Key &>()),
+                            bool>>;
+
+  static const V &_defaultValue() {
+    static const V empty{};
+    return empty;
+  }
+
+  static bool _sameKey(const K &a, const K &b) { return !(a < b || b < a); }
 
 public:
   Map() {}
   Map(std::initializer_list<std::pair<K, V>> list) {
+    _Storage &m = _write();
     for (const auto &p : list)
-      _m[p.first] = p.second;
+      m[p.first] = p.second;
+  }
+  int size() const { return _read().size(); }
+  bool isEmpty() const { return _read().empty(); }
+  void clear() { _m.reset(); }
+  void put(const K &k, const V &v) {
+    _Storage &m = _write();
+    auto it = m.find(k);
+    if (it != m.end()) {
+      it->second = v;
+    } else if constexpr (std::is_same_v<Backend, FlatBackend>) {
+      // Inserting shifts the flat array, which moves v if it is one of
+      // this map's own values (m.put(k, m.get(other)))
+      V copy = v;
+      m[k] = std::move(copy);
+    } else {
+      m[k] = v;
+    }
+  }
+  bool containsKey(const K &k) const {
+    return _read().find(k) != _read().end();
   }
-  int size() const { return _m.size(); }
-  bool isEmpty() const { return _m.empty(); }
-  void clear() { _m.clear(); }
-  void put(const K &k, const V &v) { _m[k] = v; }
-  bool containsKey(const K &k) const { return _m.find(k) != _m.end(); }
-  V get(const K &k) const {
-    auto it = _m.find(k);
-    return (it == _m.end()) ? V() : it->second;
+  template <typename Key, typename = _if_key_like<Key>>
+  bool containsKey(const Key &k) const {
+    return _read().find(k) != _read().end();
   }
-  void remove(const K &k) { _m.erase(k); }
 
-  bool equals(const Map<K, V> &map2) const {
-    if (this == &map2)
+  // Returns a reference to the stored value, or to a shared default-
+  // constructed value if the key is missing (nothing is inserted)
+  const V &get(const K &k) const {
+    auto it = _read().find(k);
+    return (it == _read().end()) ? _defaultValue() : it->second;
+  }
+  template <typename Key, typename = _if_key_like<Key>>
+  const V &get(const Key &k) const {
+    auto it = _read().find(k);
+    return (it == _read().end()) ? _defaultValue() : it->second;
+  }
+  void remove(const K &k) {
+    if (containsKey(k))
+      _write().erase(k);
+  }
+
+  bool equals(const Map &map2) const {
+    if (_m.buffer() == map2._m.buffer())
       return true;
-    if (_m.size() != map2._m.size())
+    if (size() != map2.size())
       return false;
-    for (const auto &[key, val] : _m) {
-      if (!map2.containsKey(key) || map2.get(key) != val)
+    // Both maps are ordered by key, so compare them in lockstep
+    auto it2 = map2.begin();
+    for (const auto &[key, val] : _read()) {
+      if (!_sameKey(key, it2->first) || !(val == it2->second))
         return false;
+      ++it2;
     }
     return true;
   }
@@ -38,18 +97,18 @@ public:
   K firstKey() const {
     if (isEmpty())
       error("Map::firstKey: map is empty");
-    return _m.begin()->first;
+    return _read().begin()->first;
   }
 
   K lastKey() const {
     if (isEmpty())
       error("Map::lastKey: map is empty");
-    return _m.rbegin()->first;
+    return _read().rbegin()->first;
   }
 
   Vector<K> keys() const {
     Vector<K> result;
-    for (const auto &[key, val] : _m) {
+    for (const auto &[key, val] : _read()) {
       result.add(key);
     }
     return result;
@@ -57,82 +116,98 @@ public:
 
   Vector<V> values() const {
     Vector<V> result;
-    for (const auto &[key, val] : _m) {
+    for (const auto &[key, val] : _read()) {
       result.add(val);
     }
     return result;
   }
 
-  void mapAll(std::function<void(const K &, const V &)> fn) const {
-    for (const auto &[key, val] : _m) {
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (const auto &[key, val] : _read()) {
       fn(key, val);
     }
   }
 
-  Map<K, V> &putAll(const Map<K, V> &map2) {
-    for (const auto &[key, val] : map2._m) {
+  Map &putAll(const Map &map2) {
+    for (const auto &[key, val] : map2._read()) {
       put(key, val);
     }
     return *this;
   }
 
-  Map<K, V> &removeAll(const Map<K, V> &map2) {
-    for (const auto &[key, val] : map2._m) {
-      if (containsKey(key) && get(key) == val) {
-        remove(key);
+  // removeAll and retainAll walk both ordered maps in one linear merge
+  Map &removeAll(const Map &map2) {
+    if (this == &map2) {
+      clear();
+      return *this;
+    }
+    _Storage &m = _write();
+    auto it1 = m.begin();
+    auto it2 = map2.begin();
+    while (it1 != m.end() && it2 != map2.end()) {
+      if (it1->first < it2->first) {
+        ++it1;
+      } else if (it2->first < it1->first) {
+        ++it2;
+      } else {
+        it1 = (it1->second == it2->second) ? m.erase(it1) : std::next(it1);
+        ++it2;
       }
     }
     return *this;
   }
 
-  Map<K, V> &retainAll(const Map<K, V> &map2) {
-    Vector<K> toRemove;
-    for (const auto &[key, val] : _m) {
-      if (!map2.containsKey(key) || map2.get(key) != val) {
-        toRemove.add(key);
+  Map &retainAll(const Map &map2) {
+    if (this == &map2)
+      return *this;
+    _Storage &m = _write();
+    auto it1 = m.begin();
+    auto it2 = map2.begin();
+    while (it1 != m.end()) {
+      while (it2 != map2.end() && it2->first < it1->first)
+        ++it2;
+      if (it2 != map2.end() && _sameKey(it1->first, it2->first) &&
+          it1->second == it2->second) {
+        ++it1;
+      } else {
+        it1 = m.erase(it1);
       }
     }
-    for (const K &key : toRemove) {
-      remove(key);
-    }
     return *this;
   }
 
-  V &operator[](const K &k) { return _m[k]; }
-  const V &operator[](const K &k) const {
-    auto it = _m.find(k);
-    if (it != _m.end())
-      return it->second;
-    static const V singleton{};
-    return singleton;
-  }
+  // With FlatBackend, inserting a new key moves the other values, so a
+  // reference from an earlier map[key] must not be held across it: write
+  // m[a] = m.get(b) or m.put(a, m[b]), not m[a] = m[b]
+  V &operator[](const K &k) { return _write()[k]; }
+  const V &operator[](const K &k) const { return get(k); }
 
-  Map<K, V> operator+(const Map<K, V> &map2) const {
-    Map<K, V> result = *this;
+  Map operator+(const Map &map2) const {
+    Map result = *this;
     return result.putAll(map2);
   }
 
-  Map<K, V> operator-(const Map<K, V> &map2) const {
-    Map<K, V> result = *this;
+  Map operator-(const Map &map2) const {
+    Map result = *this;
     return result.removeAll(map2);
   }
 
-  Map<K, V> operator*(const Map<K, V> &map2) const {
-    Map<K, V> result = *this;
+  Map operator*(const Map &map2) const {
+    Map result = *this;
     return result.retainAll(map2);
   }
 
-  Map<K, V> &operator+=(const Map<K, V> &map2) { return putAll(map2); }
-  Map<K, V> &operator-=(const Map<K, V> &map2) { return removeAll(map2); }
-  Map<K, V> &operator*=(const Map<K, V> &map2) { return retainAll(map2); }
+  Map &operator+=(const Map &map2) { return putAll(map2); }
+  Map &operator-=(const Map &map2) { return removeAll(map2); }
+  Map &operator*=(const Map &map2) { return retainAll(map2); }
 
   string toString() const {
     stringstream ss;
     ss << "{";
     int i = 0;
-    for (auto const &[key, val] : _m) {
+    for (auto const &[key, val] : _read()) {
       ss << key << ":" << val;
-      if (i < _m.size() - 1)
+      if (i < size() - 1)
         ss << ", ";
       i++;
     }
@@ -143,26 +218,26 @@ public:
     stringstream ss;
     ss << "{";
     int i = 0;
-    for (auto const &[key, val] : _m) {
+    for (auto const &[key, val] : _read()) {
       ss << "\"" << key << "\": " << _json_val(val);
-      if (i < _m.size() - 1)
+      if (i < size() - 1)
         ss << ", ";
       i++;
     }
     ss << "}";
-    return ss.str();
+    return _debug_shared(_m, ss.str());
   }
 
-  typename map<K, V>::iterator begin() { return _m.begin(); }
-  typename map<K, V>::iterator end() { return _m.end(); }
-  typename map<K, V>::const_iterator begin() const { return _m.begin(); }
-  typename map<K, V>::const_iterator end() const { return _m.end(); }
+  typename _Storage::iterator begin() { return _write().begin(); }
+  typename _Storage::iterator end() { return _write().end(); }
+  typename _Storage::const_iterator begin() const { return _read().begin(); }
+  typename _Storage::const_iterator end() const { return _read().end(); }
 
-  bool operator==(const Map<K, V> &map2) const { return equals(map2); }
-  bool operator!=(const Map<K, V> &map2) const { return !equals(map2); }
-  bool operator<(const Map<K, V> &map2) const {
-    auto it1 = _m.begin(), it2 = map2._m.begin();
-    auto end1 = _m.end(), end2 = map2._m.end();
+  bool operator==(const Map &map2) const { return equals(map2); }
+  bool operator!=(const Map &map2) const { return !equals(map2); }
+  bool operator<(const Map &map2) const {
+    auto it1 = begin(), it2 = map2.begin();
+    auto end1 = end(), end2 = map2.end();
     while (it1 != end1 && it2 != end2) {
       if (it1->first < it2->first)
         return true;
@@ -177,15 +252,29 @@ public:
     }
     return it1 == end1 && it2 != end2;
   }
-  bool operator<=(const Map<K, V> &map2) const {
+  bool operator<=(const Map &map2) const {
     return *this < map2 || *this == map2;
   }
-  bool operator>(const Map<K, V> &map2) const { return map2 < *this; }
-  bool operator>=(const Map<K, V> &map2) const { return map2 <= *this; }
+  bool operator>(const Map &map2) const { return map2 < *this; }
+  bool operator>=(const Map &map2) const { return map2 <= *this; }
 };
 
-template <typename K, typename V>
-ostream &operator<<(ostream &os, const Map<K, V> &m) {
+template <typename K, typename V, typename Backend>
+ostream &operator<<(ostream &os, const Map<K, V, Backend> &m) {
   os << m.toString();
   return os;
 }
+
+namespace std {
+template <typename K, typename V, typename Backend>
+struct hash<Map<K, V, Backend>> {
+  size_t operator()(const Map<K, V, Backend> &m) const {
+    size_t seed = 0;
+    for (const auto &entry : m) {
+      seed = _hashCombine(seed, std::hash<K>()(entry.first));
+      seed = _hashCombine(seed, std::hash<V>()(entry.second));
+    }
+    return seed;
+  }
+};
+} // namespace std
@@ -1,63 +1,222 @@
 #pragma once
 #include "common.h"
+#include <iterator>
+#include <memory>
 
-template <typename T> class Queue {
+// Queue is a ring buffer: one power-of-two array, with the front at _head
+// and the elements wrapping around the end. Growing doubles the array and
+// unwraps the elements to the start of it; dequeue never frees memory.
+
+template <typename T, typename Checks = DefaultChecks> class Queue {
 private:
-  deque<T> _q;
+  T *_ring = nullptr;
+  size_t _capacity = 0; // always 0 or a power of two
+  size_t _head = 0;
+  size_t _size = 0;
+
+  size_t _slot(size_t i) const { return (_head + i) & (_capacity - 1); }
+
+  void _reallocate(size_t capacity) {
+    T *ring = std::allocator<T>().allocate(capacity);
+    for (size_t i = 0; i < _size; i++) {
+      T &elem = _ring[_slot(i)];
+      new (&ring[i]) T(std::move(elem));
+      elem.~T();
+    }
+    if (_ring)
+      std::allocator<T>().deallocate(_ring, _capacity);
+    _ring = ring;
+    _capacity = capacity;
+    _head = 0;
+  }
+  T *_back() {
+    if (_size == _capacity)
+      _reallocate(_capacity ? 2 * _capacity : 8);
+    return &_ring[_slot(_size)];
+  }
+  void _release() {
+    clear();
+    if (_ring)
+      std::allocator<T>().deallocate(_ring, _capacity);
+    _ring = nullptr;
+    _capacity = 0;
+  }
+
+  template <bool Const> class _Iterator {
+  private:
+    using Q = std::conditional_t<Const, const Queue, Queue>;
+    Q *_q;
+    size_t _i;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T *, T *>;
+    using reference = std::conditional_t<Const, const T &, T &>;
+
+    _Iterator(Q *q, size_t i) : _q(q), _i(i) {}
+    reference operator*() const { return _q->_ring[_q->_slot(_i)]; }
+    pointer operator->() const { return &**this; }
+    _Iterator &operator++() {
+      _i++;
+      return *this;
+    }
+    _Iterator operator++(int) {
+      _Iterator old = *this;
+      _i++;
+      return old;
+    }
+    bool operator==(const _Iterator &other) const { return _i == other._i; }
+    bool operator!=(const _Iterator &other) const { return _i != other._i; }
+  };
 
 public:
+  using iterator = _Iterator<false>;
+  using const_iterator = _Iterator<true>;
+
   Queue() {}
-  Queue(std::initializer_list<T> list) : _q(list) {}
-  int size() const { return _q.size(); }
-  bool isEmpty() const { return _q.empty(); }
-  void clear() { _q.clear(); }
-  void enqueue(const T &val) { _q.push_back(val); }
+  Queue(std::initializer_list<T> list) {
+    reserve(list.size());
+    for (const auto &val : list)
+      enqueue(val);
+  }
+  Queue(const Queue &other) {
+    reserve(other._size);
+    for (const auto &val : other)
+      enqueue(val);
+  }
+  Queue(Queue &&other) noexcept
+      : _ring(other._ring), _capacity(other._capacity), _head(other._head),
+        _size(other._size) {
+    other._ring = nullptr;
+    other._capacity = other._head = other._size = 0;
+  }
+  Queue &operator=(const Queue &other) {
+    if (this != &other) {
+      clear();
+      reserve(other._size);
+      for (const auto &val : other)
+        enqueue(val);
+    }
+    return *this;
+  }
+  Queue &operator=(Queue &&other) noexcept {
+    if (this != &other) {
+      _release();
+      std::swap(_ring, other._ring);
+      std::swap(_capacity, other._capacity);
+      std::swap(_head, other._head);
+      std::swap(_size, other._size);
+    }
+    return *this;
+  }
+  ~Queue() { _release(); }
+
+  int size() const { return _size; }
+  bool isEmpty() const { return _size == 0; }
+  void clear() {
+    for (size_t i = 0; i < _size; i++)
+      _ring[_slot(i)].~T();
+    _head = _size = 0;
+  }
+
+  void reserve(int n) {
+    if (Checks::check && n < 0)
+      error("Queue::reserve: negative capacity");
+    if ((size_t)n <= _capacity)
+      return;
+    size_t capacity = 8;
+    while (capacity < (size_t)n)
+      capacity *= 2;
+    _reallocate(capacity);
+  }
+  int capacity() const { return _capacity; }
+
+  void enqueue(const T &val) { emplace(val); }
+  void enqueue(T &&val) { emplace(std::move(val)); }
+  template <typename... Args> T &emplace(Args &&...args) {
+    if (_size == _capacity) {
+      // args may refer into this queue, whose ring growing frees
+      T val(std::forward<Args>(args)...);
+      T *slot = _back();
+      new (slot) T(std::move(val));
+      _size++;
+      return *slot;
+    }
+    T *slot = _back();
+    new (slot) T(std::forward<Args>(args)...);
+    _size++;
+    return *slot;
+  }
   T dequeue() {
-    if (isEmpty())
+    if (Checks::check && isEmpty())
       error("Queue::dequeue: Attempting to dequeue an empty queue");
-    T val = _q.front();
-    _q.pop_front();
+    T &front = _ring[_head];
+    T val = std::move(front);
+    front.~T();
+    _head = _slot(1);
+    _size--;
     return val;
   }
   const T &peek() const {
-    if (isEmpty())
+    if (Checks::check && isEmpty())
       error("Queue::peek: Attempting to peek at an empty queue");
-    return _q.front();
+    return _ring[_head];
   }
 
-  bool equals(const Queue<T> &queue2) const { return _q == queue2._q; }
+  bool equals(const Queue &queue2) const { return *this == queue2; }
 
   string toString() const {
     stringstream ss;
     ss << "{";
-    for (size_t i = 0; i < _q.size(); i++)
-      ss << _q[i] << (i < _q.size() - 1 ? ", " : "");
+    for (size_t i = 0; i < _size; i++)
+      ss << _ring[_slot(i)] << (i < _size - 1 ? ", " : "");
     ss << "}";
     return ss.str();
   }
+  // data is front to back; head and tail are the ring slots of the front
+  // element and of the next enqueue
   string toDebugString() const {
     stringstream ss;
-    ss << "[";
-    for (size_t i = 0; i < _q.size(); i++)
-      ss << _json_val(_q[i]) << (i < _q.size() - 1 ? ", " : "");
-    ss << "]";
+    ss << "{\"__type\": \"Queue\", \"capacity\": " << _capacity
+       << ", \"head\": " << _head
+       << ", \"tail\": " << (_capacity ? _slot(_size) : 0) << ", \"data\": [";
+    for (size_t i = 0; i < _size; i++)
+      ss << _json_val(_ring[_slot(i)]) << (i < _size - 1 ? ", " : "");
+    ss << "]}";
     return ss.str();
   }
 
-  typename deque<T>::iterator begin() { return _q.begin(); }
-  typename deque<T>::iterator end() { return _q.end(); }
-  typename deque<T>::const_iterator begin() const { return _q.begin(); }
-  typename deque<T>::const_iterator end() const { return _q.end(); }
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, _size); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, _size); }
 
-  bool operator==(const Queue<T> &queue2) const { return _q == queue2._q; }
-  bool operator!=(const Queue<T> &queue2) const { return _q != queue2._q; }
-  bool operator<(const Queue<T> &queue2) const { return _q < queue2._q; }
-  bool operator<=(const Queue<T> &queue2) const { return _q <= queue2._q; }
-  bool operator>(const Queue<T> &queue2) const { return _q > queue2._q; }
-  bool operator>=(const Queue<T> &queue2) const { return _q >= queue2._q; }
+  bool operator==(const Queue &queue2) const {
+    return _size == queue2._size &&
+           std::equal(begin(), end(), queue2.begin());
+  }
+  bool operator!=(const Queue &queue2) const { return !(*this == queue2); }
+  bool operator<(const Queue &queue2) const {
+    return std::lexicographical_compare(begin(), end(), queue2.begin(),
+                                        queue2.end());
+  }
+  bool operator<=(const Queue &queue2) const { return !(queue2 < *this); }
+  bool operator>(const Queue &queue2) const { return queue2 < *this; }
+  bool operator>=(const Queue &queue2) const { return !(*this < queue2); }
 };
 
-template <typename T> ostream &operator<<(ostream &os, const Queue<T> &q) {
+template <typename T, typename Checks>
+ostream &operator<<(ostream &os, const Queue<T, Checks> &q) {
   os << q.toString();
   return os;
 }
+
+namespace std {
+template <typename T, typename Checks> struct hash<Queue<T, Checks>> {
+  size_t operator()(const Queue<T, Checks> &q) const {
+    return _hashRange(q.begin(), q.end());
+  }
+};
+} // namespace std
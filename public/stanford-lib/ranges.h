@@ -0,0 +1,314 @@
+#pragma once
+#include "common.h"
+#include "vector.h"
+#include <iterator>
+#include <type_traits>
+
+// ============================================================
+// Lazy ranges - filter, transform, take, enumerate
+// ============================================================
+// Views over any container or range that can be chained without
+// building intermediate Vectors:
+//
+//   for (int x : lazy::take(lazy::filter(nums, isEven), 3)) ...
+//   for (auto [i, word] : lazy::enumerate(words)) ...
+//   Vector<int> lengths = words | lazy::transform(len) | lazy::toVector();
+//   int total = lazy::reduce(grid.rows() | lazy::transform(rowSum), 0,
+//                            plus<int>());
+//
+// Everything is in namespace lazy so that a student's own filter or
+// reduce is never outbid by these templates.
+//
+// Nothing happens until the loop asks for the next element, and each
+// step is an inlined call on the underlying iterator, so a pipeline
+// compiles to the loop you would write by hand. A view keeps a
+// reference to a container passed by name (which must outlive it), and
+// its own copy of a temporary. Elements are passed through by
+// reference, so for (int &x : lazy::filter(v, pred)) x = 0; updates v.
+
+namespace lazy {
+
+template <typename R>
+using _RangeIter = decltype(std::begin(std::declval<R &>()));
+template <typename R>
+using _RangeRef = decltype(*std::declval<_RangeIter<R> &>());
+
+template <typename R, typename = void> struct _IsRange : std::false_type {};
+template <typename R>
+struct _IsRange<R, std::void_t<_RangeIter<R>,
+                               decltype(std::end(std::declval<R &>()))>>
+    : std::true_type {};
+
+// fn can be applied to the elements of R
+template <typename R, typename Fn, typename = void>
+struct _AppliesTo : std::false_type {};
+template <typename R, typename Fn>
+struct _AppliesTo<R, Fn, std::enable_if_t<_IsRange<R>::value>>
+    : std::is_invocable<Fn &, _RangeRef<R>> {};
+
+// Lambdas, function objects and functions, as opposed to ranges or
+// plain values
+template <typename Fn>
+constexpr bool _isCallable =
+    !_IsRange<Fn>::value &&
+    (std::is_class_v<Fn> || std::is_function_v<std::remove_pointer_t<Fn>>);
+
+template <typename R, typename Pred> class FilterRange {
+private:
+  R _range;
+  Pred _pred;
+
+public:
+  class iterator {
+  private:
+    _RangeIter<R> _it, _end;
+    Pred *_pred;
+
+    void _skip() {
+      while (_it != _end && !(*_pred)(*_it))
+        ++_it;
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::decay_t<_RangeRef<R>>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = _RangeRef<R>;
+
+    iterator(_RangeIter<R> it, _RangeIter<R> end, Pred *pred)
+        : _it(it), _end(end), _pred(pred) {
+      _skip();
+    }
+    reference operator*() const { return *_it; }
+    iterator &operator++() {
+      ++_it;
+      _skip();
+      return *this;
+    }
+    bool operator==(const iterator &other) const { return _it == other._it; }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  FilterRange(R &&range, Pred pred)
+      : _range(std::forward<R>(range)), _pred(std::move(pred)) {}
+  iterator begin() {
+    return iterator(std::begin(_range), std::end(_range), &_pred);
+  }
+  iterator end() {
+    return iterator(std::end(_range), std::end(_range), &_pred);
+  }
+};
+
+template <typename R, typename Fn> class TransformRange {
+private:
+  R _range;
+  Fn _fn;
+
+public:
+  class iterator {
+  private:
+    _RangeIter<R> _it;
+    Fn *_fn;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using reference = std::invoke_result_t<Fn &, _RangeRef<R>>;
+    using value_type = std::decay_t<reference>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+
+    iterator(_RangeIter<R> it, Fn *fn) : _it(it), _fn(fn) {}
+    reference operator*() const { return (*_fn)(*_it); }
+    iterator &operator++() {
+      ++_it;
+      return *this;
+    }
+    bool operator==(const iterator &other) const { return _it == other._it; }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  TransformRange(R &&range, Fn fn)
+      : _range(std::forward<R>(range)), _fn(std::move(fn)) {}
+  iterator begin() { return iterator(std::begin(_range), &_fn); }
+  iterator end() { return iterator(std::end(_range), &_fn); }
+};
+
+template <typename R> class TakeRange {
+private:
+  R _range;
+  int _count;
+
+public:
+  class iterator {
+  private:
+    _RangeIter<R> _it, _end;
+    int _left;
+
+    bool _done() const { return _left <= 0 || _it == _end; }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::decay_t<_RangeRef<R>>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = _RangeRef<R>;
+
+    iterator(_RangeIter<R> it, _RangeIter<R> end, int left)
+        : _it(it), _end(end), _left(left) {}
+    reference operator*() const { return *_it; }
+    iterator &operator++() {
+      // The last step does not advance, so a filter underneath stops
+      // searching as soon as it has produced enough
+      if (--_left > 0)
+        ++_it;
+      return *this;
+    }
+    bool operator==(const iterator &other) const {
+      return _done() == other._done() && (_done() || _it == other._it);
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  TakeRange(R &&range, int count)
+      : _range(std::forward<R>(range)), _count(count) {}
+  iterator begin() {
+    return iterator(std::begin(_range), std::end(_range), _count);
+  }
+  iterator end() { return iterator(std::end(_range), std::end(_range), 0); }
+};
+
+// One element of enumerate(): for (auto [index, value] : enumerate(v))
+template <typename Ref> struct Enumerated {
+  int index;
+  Ref value;
+};
+
+template <typename R> class EnumerateRange {
+private:
+  R _range;
+
+public:
+  class iterator {
+  private:
+    _RangeIter<R> _it;
+    int _index;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Enumerated<_RangeRef<R>>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    iterator(_RangeIter<R> it, int index) : _it(it), _index(index) {}
+    value_type operator*() const { return {_index, *_it}; }
+    iterator &operator++() {
+      ++_it;
+      ++_index;
+      return *this;
+    }
+    bool operator==(const iterator &other) const { return _it == other._it; }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  explicit EnumerateRange(R &&range) : _range(std::forward<R>(range)) {}
+  iterator begin() { return iterator(std::begin(_range), 0); }
+  iterator end() { return iterator(std::end(_range), -1); }
+};
+
+// ============================================================
+// Factories
+// ============================================================
+
+template <typename R, typename Pred,
+          typename = std::enable_if_t<_AppliesTo<R, Pred>::value>>
+FilterRange<R, Pred> filter(R &&range, Pred pred) {
+  return FilterRange<R, Pred>(std::forward<R>(range), std::move(pred));
+}
+
+template <typename R, typename Fn,
+          typename = std::enable_if_t<_AppliesTo<R, Fn>::value>>
+TransformRange<R, Fn> transform(R &&range, Fn fn) {
+  return TransformRange<R, Fn>(std::forward<R>(range), std::move(fn));
+}
+
+template <typename R, typename = std::enable_if_t<_IsRange<R>::value>>
+TakeRange<R> take(R &&range, int count) {
+  return TakeRange<R>(std::forward<R>(range), count);
+}
+
+template <typename R, typename = std::enable_if_t<_IsRange<R>::value>>
+EnumerateRange<R> enumerate(R &&range) {
+  return EnumerateRange<R>(std::forward<R>(range));
+}
+
+// Folds the elements into init from left to right: fn(fn(init, a), b)...
+template <typename R, typename T, typename Fn,
+          typename = std::enable_if_t<_IsRange<R>::value>>
+T reduce(R &&range, T init, Fn fn) {
+  for (auto &&elem : range)
+    init = fn(std::move(init), elem);
+  return init;
+}
+
+// Copies the elements into a Vector
+template <typename R, typename = std::enable_if_t<_IsRange<R>::value>>
+Vector<std::decay_t<_RangeRef<R>>> toVector(R &&range) {
+  Vector<std::decay_t<_RangeRef<R>>> result;
+  for (auto &&elem : range)
+    result.add(elem);
+  return result;
+}
+
+// ============================================================
+// Pipeline form: range | filter(pred) | transform(fn) | take(n)
+// ============================================================
+
+template <typename Pred> struct _FilterStep { Pred pred; };
+template <typename Fn> struct _TransformStep { Fn fn; };
+struct _TakeStep {
+  int count;
+};
+struct _EnumerateStep {};
+struct _ToVectorStep {};
+
+template <typename Pred, typename = std::enable_if_t<_isCallable<Pred>>>
+_FilterStep<Pred> filter(Pred pred) {
+  return {std::move(pred)};
+}
+template <typename Fn, typename = std::enable_if_t<_isCallable<Fn>>>
+_TransformStep<Fn> transform(Fn fn) {
+  return {std::move(fn)};
+}
+_TakeStep take(int count) { return {count}; }
+_EnumerateStep enumerate() { return {}; }
+_ToVectorStep toVector() { return {}; }
+
+template <typename R, typename Pred>
+auto operator|(R &&range, _FilterStep<Pred> step)
+    -> decltype(filter(std::forward<R>(range), std::move(step.pred))) {
+  return filter(std::forward<R>(range), std::move(step.pred));
+}
+template <typename R, typename Fn>
+auto operator|(R &&range, _TransformStep<Fn> step)
+    -> decltype(transform(std::forward<R>(range), std::move(step.fn))) {
+  return transform(std::forward<R>(range), std::move(step.fn));
+}
+template <typename R>
+auto operator|(R &&range, _TakeStep step)
+    -> decltype(take(std::forward<R>(range), step.count)) {
+  return take(std::forward<R>(range), step.count);
+}
+template <typename R>
+auto operator|(R &&range, _EnumerateStep)
+    -> decltype(enumerate(std::forward<R>(range))) {
+  return enumerate(std::forward<R>(range));
+}
+template <typename R>
+auto operator|(R &&range, _ToVectorStep)
+    -> decltype(toVector(std::forward<R>(range))) {
+  return toVector(std::forward<R>(range));
+}
+
+} // namespace lazy
@@ -1,9 +1,55 @@
 #pragma once
 #include "common.h"
+#include "flatstorage.h"
+#include <iterator>
 
-template <typename T> class Set {
+template <typename T, typename Backend = DefaultOrderedBackend> class Set {
 private:
-  set<T> _s;
+  using _Storage = typename Backend::template set_type<T>;
+  _Shareable<_Storage> _s;
+
+  const _Storage &_read() const { return _s.read(); }
+  _Storage &_write() { return _s.write(); }
+
+  template <typename S>
+  static auto _reserve(S &s, size_t n, int) -> decltype(s.reserve(n)) {
+    s.reserve(n);
+  }
+  template <typename S> static void _reserve(S &, size_t, long) {}
+
+  // The set algebra walks both operands in order and appends each result
+  // element at end(), so every operation is a single O(n + m) merge
+  static _Storage _union(const _Storage &a, const _Storage &b) {
+    _Storage result;
+    _reserve(result, a.size() + b.size(), 0);
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::inserter(result, result.end()));
+    return result;
+  }
+  static _Storage _intersection(const _Storage &a, const _Storage &b) {
+    const _Storage &small = a.size() <= b.size() ? a : b;
+    const _Storage &big = a.size() <= b.size() ? b : a;
+    _Storage result;
+    _reserve(result, small.size(), 0);
+    if (small.size() * 8 < big.size()) {
+      // Far smaller side: O(log m) lookups beat walking all of big
+      for (const auto &val : small) {
+        if (big.find(val) != big.end())
+          result.insert(result.end(), val);
+      }
+    } else {
+      std::set_intersection(small.begin(), small.end(), big.begin(),
+                            big.end(), std::inserter(result, result.end()));
+    }
+    return result;
+  }
+  static _Storage _difference(const _Storage &a, const _Storage &b) {
+    _Storage result;
+    _reserve(result, a.size(), 0);
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::inserter(result, result.end()));
+    return result;
+  }
 
 public:
   Set() {}
@@ -11,20 +57,29 @@ public:
     for (const auto &item : list)
       add(item);
   }
-  int size() const { return _s.size(); }
-  bool isEmpty() const { return _s.empty(); }
-  void clear() { _s.clear(); }
-  void add(const T &val) { _s.insert(val); }
-  bool contains(const T &val) const { return _s.find(val) != _s.end(); }
-  void remove(const T &val) { _s.erase(val); }
+  int size() const { return _read().size(); }
+  bool isEmpty() const { return _read().empty(); }
+  void clear() { _s.reset(); }
+  void add(const T &val) { _write().insert(val); }
+  void add(T &&val) { _write().insert(std::move(val)); }
+  template <typename... Args> void emplace(Args &&...args) {
+    _write().emplace(std::forward<Args>(args)...);
+  }
+  bool contains(const T &val) const {
+    return _read().find(val) != _read().end();
+  }
+  void remove(const T &val) {
+    if (contains(val))
+      _write().erase(val);
+  }
 
-  bool equals(const Set<T> &set2) const {
-    if (this == &set2)
+  bool equals(const Set &set2) const {
+    if (_s.buffer() == set2._s.buffer())
       return true;
-    if (_s.size() != set2._s.size())
+    if (size() != set2.size())
       return false;
-    auto it1 = _s.begin(), it2 = set2._s.begin();
-    while (it1 != _s.end() && it2 != set2._s.end()) {
+    auto it1 = begin(), it2 = set2.begin();
+    while (it1 != end() && it2 != set2.end()) {
       if (*it1 != *it2)
         return false;
       ++it1;
@@ -36,106 +91,141 @@ public:
   T first() const {
     if (isEmpty())
       error("Set::first: set is empty");
-    return *_s.begin();
+    return *begin();
   }
 
   T last() const {
     if (isEmpty())
       error("Set::last: set is empty");
-    return *_s.rbegin();
+    return *_read().rbegin();
   }
 
-  void mapAll(std::function<void(const T &)> fn) const {
-    for (const auto &elem : _s)
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (const auto &elem : _read())
       fn(elem);
   }
 
-  Set<T> &difference(const Set<T> &set2) {
-    for (const auto &val : set2._s) {
-      _s.erase(val);
-    }
+  Set &difference(const Set &set2) {
+    if (this == &set2)
+      clear();
+    else if (!isEmpty() && !set2.isEmpty())
+      _s.assign(_difference(_read(), set2._read()));
     return *this;
   }
 
-  Set<T> &intersect(const Set<T> &set2) {
-    Set<T> result;
-    for (const auto &val : _s) {
-      if (set2.contains(val))
-        result.add(val);
-    }
-    _s = result._s;
+  Set &intersect(const Set &set2) {
+    if (this != &set2)
+      _s.assign(_intersection(_read(), set2._read()));
     return *this;
   }
 
-  Set<T> &unionWith(const Set<T> &set2) {
-    for (const auto &val : set2._s) {
-      add(val);
-    }
+  Set &unionWith(const Set &set2) {
+    if (isEmpty())
+      _s = set2._s;
+    else if (this != &set2 && !set2.isEmpty())
+      _s.assign(_union(_read(), set2._read()));
+    return *this;
+  }
+  Set &unionWith(Set &&set2) {
+    if (isEmpty())
+      _s = std::move(set2._s);
+    else if (this != &set2 && !set2.isEmpty())
+      _s.assign(_union(_read(), set2._read()));
     return *this;
   }
 
-  bool isSubsetOf(const Set<T> &set2) const {
-    for (const auto &val : _s) {
-      if (!set2.contains(val))
-        return false;
+  bool isSubsetOf(const Set &set2) const {
+    if (size() > set2.size())
+      return false;
+    if (size() * 8 < set2.size()) {
+      for (const auto &val : _read()) {
+        if (!set2.contains(val))
+          return false;
+      }
+      return true;
     }
-    return true;
+    return std::includes(set2.begin(), set2.end(), begin(), end());
   }
 
-  bool isSupersetOf(const Set<T> &set2) const { return set2.isSubsetOf(*this); }
+  bool isSupersetOf(const Set &set2) const { return set2.isSubsetOf(*this); }
 
-  Set<T> operator+(const Set<T> &set2) const {
-    Set<T> result = *this;
-    return result.unionWith(set2);
+  // The const & operators build the result in one merge; the && ones
+  // reuse a temporary left operand, so a + b + c makes no extra copies
+  Set operator+(const Set &set2) const & {
+    Set result;
+    result._s.assign(_union(_read(), set2._read()));
+    return result;
   }
+  Set operator+(const Set &set2) && { return std::move(unionWith(set2)); }
 
-  Set<T> operator+(const T &element) const {
-    Set<T> result = *this;
+  Set operator+(const T &element) const & {
+    Set result = *this;
     result.add(element);
     return result;
   }
+  Set operator+(const T &element) && {
+    add(element);
+    return std::move(*this);
+  }
 
-  Set<T> operator*(const Set<T> &set2) const {
-    Set<T> result = *this;
-    return result.intersect(set2);
+  Set operator*(const Set &set2) const & {
+    Set result;
+    result._s.assign(_intersection(_read(), set2._read()));
+    return result;
   }
+  Set operator*(const Set &set2) && { return std::move(intersect(set2)); }
 
-  Set<T> operator-(const Set<T> &set2) const {
-    Set<T> result = *this;
-    return result.difference(set2);
+  Set operator-(const Set &set2) const & {
+    Set result;
+    result._s.assign(_difference(_read(), set2._read()));
+    return result;
   }
+  Set operator-(const Set &set2) && { return std::move(difference(set2)); }
 
-  Set<T> operator-(const T &element) const {
-    Set<T> result = *this;
+  Set operator-(const T &element) const & {
+    Set result = *this;
     result.remove(element);
     return result;
   }
+  Set operator-(const T &element) && {
+    remove(element);
+    return std::move(*this);
+  }
 
-  Set<T> &operator+=(const Set<T> &set2) { return unionWith(set2); }
-  Set<T> &operator+=(const T &val) {
+  Set &operator+=(const Set &set2) { return unionWith(set2); }
+  Set &operator+=(Set &&set2) { return unionWith(std::move(set2)); }
+  Set &operator+=(const T &val) {
     add(val);
     return *this;
   }
+  Set &operator+=(T &&val) {
+    add(std::move(val));
+    return *this;
+  }
 
-  Set<T> &operator*=(const Set<T> &set2) { return intersect(set2); }
+  Set &operator*=(const Set &set2) { return intersect(set2); }
 
-  Set<T> &operator-=(const Set<T> &set2) { return difference(set2); }
-  Set<T> &operator-=(const T &val) {
+  Set &operator-=(const Set &set2) { return difference(set2); }
+  Set &operator-=(const T &val) {
     remove(val);
     return *this;
   }
 
-  Set<T> &operator,(const T &value) {
+  Set &operator,(const T &value) {
     add(value);
     return *this;
   }
+  Set &operator,(T &&value) {
+    add(std::move(value));
+    return *this;
+  }
 
   string toString() const {
     stringstream ss;
     ss << "{";
     int i = 0;
-    for (const auto &val : _s) {
-      ss << val << (i < _s.size() - 1 ? ", " : "");
+    for (const auto &val : _read()) {
+      ss << val << (i < size() - 1 ? ", " : "");
       i++;
     }
     ss << "}";
@@ -145,24 +235,23 @@ public:
     stringstream ss;
     ss << "[";
     int i = 0;
-    for (const auto &val : _s) {
-      ss << _json_val(val) << (i < _s.size() - 1 ? ", " : "");
+    for (const auto &val : _read()) {
+      ss << _json_val(val) << (i < size() - 1 ? ", " : "");
       i++;
     }
     ss << "]";
-    return ss.str();
+    return _debug_shared(_s, ss.str());
   }
 
-  typename set<T>::iterator begin() { return _s.begin(); }
-  typename set<T>::iterator end() { return _s.end(); }
-  typename set<T>::const_iterator begin() const { return _s.begin(); }
-  typename set<T>::const_iterator end() const { return _s.end(); }
+  // Set elements are read-only, so iterating never clones a shared buffer
+  typename _Storage::const_iterator begin() const { return _read().begin(); }
+  typename _Storage::const_iterator end() const { return _read().end(); }
 
-  bool operator==(const Set<T> &set2) const { return equals(set2); }
-  bool operator!=(const Set<T> &set2) const { return !equals(set2); }
-  bool operator<(const Set<T> &set2) const {
-    auto it1 = _s.begin(), it2 = set2._s.begin();
-    auto end1 = _s.end(), end2 = set2._s.end();
+  bool operator==(const Set &set2) const { return equals(set2); }
+  bool operator!=(const Set &set2) const { return !equals(set2); }
+  bool operator<(const Set &set2) const {
+    auto it1 = begin(), it2 = set2.begin();
+    auto end1 = end(), end2 = set2.end();
     while (it1 != end1 && it2 != end2) {
       if (*it1 < *it2)
         return true;
@@ -173,14 +262,23 @@ public:
     }
     return it1 == end1 && it2 != end2;
   }
-  bool operator<=(const Set<T> &set2) const {
+  bool operator<=(const Set &set2) const {
     return *this < set2 || *this == set2;
   }
-  bool operator>(const Set<T> &set2) const { return set2 < *this; }
-  bool operator>=(const Set<T> &set2) const { return set2 <= *this; }
+  bool operator>(const Set &set2) const { return set2 < *this; }
+  bool operator>=(const Set &set2) const { return set2 <= *this; }
 };
 
-template <typename T> ostream &operator<<(ostream &os, const Set<T> &s) {
+template <typename T, typename Backend>
+ostream &operator<<(ostream &os, const Set<T, Backend> &s) {
   os << s.toString();
   return os;
 }
+
+namespace std {
+template <typename T, typename Backend> struct hash<Set<T, Backend>> {
+  size_t operator()(const Set<T, Backend> &s) const {
+    return _hashRange(s.begin(), s.end());
+  }
+};
+} // namespace std
@@ -0,0 +1,267 @@
+#pragma once
+#include "common.h"
+#include <functional>
+
+// ============================================================
+// SmallIntSet - set of integers in [0, N), one bit per value
+// ============================================================
+// A drop-in for Set<int> when the values are small and bounded (digits,
+// indices, vertex ids): SmallIntSet<10> digits; SmallIntSet<64> used;
+// The whole set is N bits stored inside the object, so copying one is a
+// few word copies and never allocates, which is what recursive
+// backtracking does at every level. Union, intersection, difference and
+// subset tests work 64 values at a time, and size() is a popcount.
+// Iteration is in increasing order, like Set<int>.
+
+template <int N = 64, typename Checks = DefaultChecks> class SmallIntSet {
+  static_assert(N > 0, "SmallIntSet needs a positive universe size");
+
+private:
+  static constexpr int kWords = (N + 63) / 64;
+  uint64_t _bits[kWords] = {};
+
+  static bool _inRange(int value) { return value >= 0 && value < N; }
+  void _checkValue(int value, const char *prefix) const {
+    if (Checks::check && !_inRange(value))
+      error(string("SmallIntSet::") + prefix + ": value " + to_string(value) +
+            " is outside of valid range [0, " + to_string(N) + ")");
+  }
+  static uint64_t _bit(int value) { return uint64_t(1) << (value & 63); }
+
+public:
+  class iterator {
+  private:
+    const uint64_t *_bits;
+    int _word;
+    uint64_t _rest; // values of _word not visited yet
+
+    void _skipEmpty() {
+      while (_rest == 0 && _word < kWords) {
+        if (++_word < kWords)
+          _rest = _bits[_word];
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int *;
+    using reference = int;
+
+    iterator(const uint64_t *bits, int word)
+        : _bits(bits), _word(word), _rest(word < kWords ? bits[word] : 0) {
+      _skipEmpty();
+    }
+    int operator*() const { return _word * 64 + __builtin_ctzll(_rest); }
+    iterator &operator++() {
+      _rest &= _rest - 1;
+      _skipEmpty();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const iterator &other) const {
+      return _word == other._word && _rest == other._rest;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+  using const_iterator = iterator;
+
+  SmallIntSet() {}
+  SmallIntSet(std::initializer_list<int> list) {
+    for (int value : list)
+      add(value);
+  }
+
+  // Every value in [0, N)
+  static SmallIntSet all() { return SmallIntSet().complement(); }
+  static constexpr int capacity() { return N; }
+
+  int size() const {
+    int count = 0;
+    for (int i = 0; i < kWords; i++)
+      count += __builtin_popcountll(_bits[i]);
+    return count;
+  }
+  bool isEmpty() const {
+    for (int i = 0; i < kWords; i++) {
+      if (_bits[i])
+        return false;
+    }
+    return true;
+  }
+  void clear() {
+    for (int i = 0; i < kWords; i++)
+      _bits[i] = 0;
+  }
+
+  void add(int value) {
+    _checkValue(value, "add");
+    _bits[value >> 6] |= _bit(value);
+  }
+  bool contains(int value) const {
+    return _inRange(value) && (_bits[value >> 6] & _bit(value));
+  }
+  void remove(int value) {
+    if (_inRange(value))
+      _bits[value >> 6] &= ~_bit(value);
+  }
+
+  bool equals(const SmallIntSet &set2) const {
+    for (int i = 0; i < kWords; i++) {
+      if (_bits[i] != set2._bits[i])
+        return false;
+    }
+    return true;
+  }
+
+  int first() const {
+    for (int i = 0; i < kWords; i++) {
+      if (_bits[i])
+        return i * 64 + __builtin_ctzll(_bits[i]);
+    }
+    error("SmallIntSet::first: set is empty");
+    return -1;
+  }
+  int last() const {
+    for (int i = kWords - 1; i >= 0; i--) {
+      if (_bits[i])
+        return i * 64 + 63 - __builtin_clzll(_bits[i]);
+    }
+    error("SmallIntSet::last: set is empty");
+    return -1;
+  }
+
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (int value : *this)
+      fn(value);
+  }
+
+  SmallIntSet &difference(const SmallIntSet &set2) {
+    for (int i = 0; i < kWords; i++)
+      _bits[i] &= ~set2._bits[i];
+    return *this;
+  }
+  SmallIntSet &intersect(const SmallIntSet &set2) {
+    for (int i = 0; i < kWords; i++)
+      _bits[i] &= set2._bits[i];
+    return *this;
+  }
+  SmallIntSet &unionWith(const SmallIntSet &set2) {
+    for (int i = 0; i < kWords; i++)
+      _bits[i] |= set2._bits[i];
+    return *this;
+  }
+  // The values in [0, N) that are not in this set
+  SmallIntSet complement() const {
+    SmallIntSet result;
+    for (int i = 0; i < kWords; i++)
+      result._bits[i] = ~_bits[i];
+    if (N % 64)
+      result._bits[kWords - 1] &= (uint64_t(1) << (N % 64)) - 1;
+    return result;
+  }
+
+  bool isSubsetOf(const SmallIntSet &set2) const {
+    for (int i = 0; i < kWords; i++) {
+      if (_bits[i] & ~set2._bits[i])
+        return false;
+    }
+    return true;
+  }
+  bool isSupersetOf(const SmallIntSet &set2) const {
+    return set2.isSubsetOf(*this);
+  }
+
+  SmallIntSet operator+(const SmallIntSet &set2) const {
+    return SmallIntSet(*this).unionWith(set2);
+  }
+  SmallIntSet operator+(int element) const {
+    SmallIntSet result = *this;
+    result.add(element);
+    return result;
+  }
+  SmallIntSet operator*(const SmallIntSet &set2) const {
+    return SmallIntSet(*this).intersect(set2);
+  }
+  SmallIntSet operator-(const SmallIntSet &set2) const {
+    return SmallIntSet(*this).difference(set2);
+  }
+  SmallIntSet operator-(int element) const {
+    SmallIntSet result = *this;
+    result.remove(element);
+    return result;
+  }
+
+  SmallIntSet &operator+=(const SmallIntSet &set2) { return unionWith(set2); }
+  SmallIntSet &operator+=(int value) {
+    add(value);
+    return *this;
+  }
+  SmallIntSet &operator*=(const SmallIntSet &set2) { return intersect(set2); }
+  SmallIntSet &operator-=(const SmallIntSet &set2) { return difference(set2); }
+  SmallIntSet &operator-=(int value) {
+    remove(value);
+    return *this;
+  }
+  SmallIntSet &operator,(int value) {
+    add(value);
+    return *this;
+  }
+
+  string toString() const {
+    stringstream ss;
+    ss << "{";
+    bool first = true;
+    for (int value : *this) {
+      ss << (first ? "" : ", ") << value;
+      first = false;
+    }
+    ss << "}";
+    return ss.str();
+  }
+  // Same format as Set<int>
+  string toDebugString() const {
+    stringstream ss;
+    ss << "[";
+    bool first = true;
+    for (int value : *this) {
+      ss << (first ? "" : ", ") << value;
+      first = false;
+    }
+    ss << "]";
+    return ss.str();
+  }
+
+  iterator begin() const { return iterator(_bits, 0); }
+  iterator end() const { return iterator(_bits, kWords); }
+
+  bool operator==(const SmallIntSet &set2) const { return equals(set2); }
+  bool operator!=(const SmallIntSet &set2) const { return !equals(set2); }
+  // Compares the sorted values lexicographically, as Set does
+  bool operator<(const SmallIntSet &set2) const {
+    return std::lexicographical_compare(begin(), end(), set2.begin(),
+                                        set2.end());
+  }
+  bool operator<=(const SmallIntSet &set2) const { return !(set2 < *this); }
+  bool operator>(const SmallIntSet &set2) const { return set2 < *this; }
+  bool operator>=(const SmallIntSet &set2) const { return !(*this < set2); }
+};
+
+template <int N, typename Checks>
+ostream &operator<<(ostream &os, const SmallIntSet<N, Checks> &s) {
+  os << s.toString();
+  return os;
+}
+
+namespace std {
+template <int N, typename Checks> struct hash<SmallIntSet<N, Checks>> {
+  size_t operator()(const SmallIntSet<N, Checks> &s) const {
+    return _hashRange(s.begin(), s.end());
+  }
+};
+} // namespace std
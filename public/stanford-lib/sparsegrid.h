@@ -0,0 +1,395 @@
+#pragma once
+#include "common.h"
+#include "flathash.h"
+#include "grid.h"
+#include <array>
+
+// ============================================================
+// SparseGrid - Grid for huge, mostly empty boards
+// ============================================================
+// Same interface as Grid, but cells live in 8x8 tiles that are allocated
+// the first time one of their cells is written. Every other cell reads as
+// the background value (T() unless given), so a 100000 x 100000 board
+// with a few thousand live cells takes kilobytes. Each tile keeps a bit
+// per cell that has been written, which lets nonDefaultLocations() and
+// mapNonDefault() run in time proportional to the live cells rather than
+// to numRows() * numCols(). A tile is freed when all of its cells are set
+// back to the background.
+//
+// On a non-const SparseGrid, grid[r][c] and grid[loc] give a CellRef
+// rather than a T&. Reading one never allocates, so scanning the board or
+// checking neighbours creates no tiles; only assigning to it writes the
+// cell. cell(r, c) gives a real T& for calling methods on a cell, and
+// allocates its tile.
+
+template <typename T, typename Checks = DefaultChecks> class SparseGrid {
+private:
+  static constexpr int kTileShift = 3;
+  static constexpr int kTileSide = 1 << kTileShift;
+
+  struct _Tile {
+    uint64_t key;
+    uint64_t written = 0; // bit (row % 8) * 8 + (col % 8)
+    std::array<T, kTileSide * kTileSide> cells;
+  };
+  struct _KeyOf {
+    uint64_t operator()(const std::pair<uint64_t, int> &e) const {
+      return e.first;
+    }
+  };
+
+  int _r = 0, _c = 0;
+  T _background = T();
+  vector<_Tile> _tiles;
+  // Tile key -> index into _tiles
+  FlatHashTable<std::pair<uint64_t, int>, uint64_t, _KeyOf> _index;
+
+  static uint64_t _key(int r, int c) {
+    return (uint64_t)(uint32_t)(r >> kTileShift) << 32 |
+           (uint32_t)(c >> kTileShift);
+  }
+  static int _bit(int r, int c) {
+    return (r & (kTileSide - 1)) * kTileSide + (c & (kTileSide - 1));
+  }
+  static GridLocation _location(uint64_t key, int bit) {
+    return GridLocation((int)(key >> 32) * kTileSide + bit / kTileSide,
+                        (int)(uint32_t)key * kTileSide + bit % kTileSide);
+  }
+
+  const _Tile *_findTile(int r, int c) const {
+    auto it = _index.find(_key(r, c));
+    return it == _index.end() ? nullptr : &_tiles[it->second];
+  }
+  _Tile &_tileFor(int r, int c) {
+    uint64_t key = _key(r, c);
+    auto [it, added] = _index.tryEmplace(key, key, (int)_tiles.size());
+    if (added) {
+      _tiles.push_back({key});
+      _tiles.back().cells.fill(_background);
+    }
+    return _tiles[it->second];
+  }
+  void _freeTile(uint64_t key) {
+    auto it = _index.find(key);
+    int i = it->second;
+    _index.erase(it);
+    if (i != (int)_tiles.size() - 1) {
+      _tiles[i] = std::move(_tiles.back());
+      _index.find(_tiles[i].key)->second = i;
+    }
+    _tiles.pop_back();
+  }
+  T &_cell(int r, int c) {
+    _Tile &tile = _tileFor(r, c);
+    tile.written |= uint64_t(1) << _bit(r, c);
+    return tile.cells[_bit(r, c)];
+  }
+
+  void _checkIndexes(int row, int col, const char *prefix) const {
+    if (!Checks::check)
+      return;
+    if (row < 0 || row >= _r || col < 0 || col >= _c) {
+      stringstream ss;
+      ss << "SparseGrid::" << prefix << ": (" << row << ", " << col
+         << ") is outside of valid range [";
+      if (_r > 0 && _c > 0) {
+        ss << "(0, 0)..(" << (_r - 1) << ", " << (_c - 1) << ")";
+      }
+      ss << "]";
+      error(ss.str());
+    }
+  }
+
+public:
+  // A cell of a non-const grid: reads go through get(), writes through
+  // set(). Note that auto x = grid[r][c] copies the reference, not the
+  // value.
+  class CellRef {
+  private:
+    SparseGrid *_g;
+    int _row, _col;
+
+    template <typename Op> CellRef &_update(Op op) {
+      T val = get();
+      op(val);
+      _g->set(_row, _col, val);
+      return *this;
+    }
+
+  public:
+    CellRef(SparseGrid *g, int row, int col) : _g(g), _row(row), _col(col) {}
+    CellRef(const CellRef &) = default;
+
+    const T &get() const { return _g->get(_row, _col); }
+    operator const T &() const { return get(); }
+
+    CellRef &operator=(const T &val) {
+      _g->set(_row, _col, val);
+      return *this;
+    }
+    CellRef &operator=(const CellRef &other) { return *this = other.get(); }
+    template <typename U> CellRef &operator+=(const U &x) {
+      return _update([&](T &val) { val += x; });
+    }
+    template <typename U> CellRef &operator-=(const U &x) {
+      return _update([&](T &val) { val -= x; });
+    }
+    template <typename U> CellRef &operator*=(const U &x) {
+      return _update([&](T &val) { val *= x; });
+    }
+    template <typename U> CellRef &operator/=(const U &x) {
+      return _update([&](T &val) { val /= x; });
+    }
+    template <typename U> CellRef &operator%=(const U &x) {
+      return _update([&](T &val) { val %= x; });
+    }
+    CellRef &operator++() {
+      return _update([](T &val) { ++val; });
+    }
+    CellRef &operator--() {
+      return _update([](T &val) { --val; });
+    }
+    T operator++(int) {
+      T old = get();
+      ++*this;
+      return old;
+    }
+    T operator--(int) {
+      T old = get();
+      --*this;
+      return old;
+    }
+
+    // Spelled out because templated operators such as string's do not
+    // look through the conversion to const T&
+    friend bool operator==(const CellRef &a, const T &b) {
+      return a.get() == b;
+    }
+    friend bool operator==(const T &a, const CellRef &b) {
+      return a == b.get();
+    }
+    friend bool operator==(const CellRef &a, const CellRef &b) {
+      return a.get() == b.get();
+    }
+    friend bool operator!=(const CellRef &a, const T &b) { return !(a == b); }
+    friend bool operator!=(const T &a, const CellRef &b) { return !(a == b); }
+    friend bool operator!=(const CellRef &a, const CellRef &b) {
+      return !(a == b);
+    }
+    friend ostream &operator<<(ostream &os, const CellRef &ref) {
+      return os << ref.get();
+    }
+  };
+
+private:
+  // grid[r][c] support: a row whose cells are only written by assignment
+  template <bool Const> class _Row {
+  private:
+    using G = std::conditional_t<Const, const SparseGrid, SparseGrid>;
+    G *_g;
+    int _row;
+
+  public:
+    _Row(G *g, int row) : _g(g), _row(row) {}
+    std::conditional_t<Const, const T &, CellRef> operator[](int col) const {
+      return (*_g)[GridLocation(_row, col)];
+    }
+  };
+
+public:
+  SparseGrid() {}
+  SparseGrid(int r, int c) { resize(r, c); }
+  SparseGrid(int r, int c, const T &background) : _background(background) {
+    resize(r, c);
+  }
+
+  void clear() { fill(T()); }
+  // Sets every cell by changing the background and dropping all tiles
+  void fill(const T &value) {
+    _background = value;
+    _tiles.clear();
+    _index.clear();
+  }
+
+  void resize(int r, int c, bool retain = false) {
+    if (r < 0 || c < 0) {
+      stringstream ss;
+      ss << "SparseGrid::resize: Attempt to resize grid to invalid size ("
+         << r << ", " << c << ")";
+      error(ss.str());
+    }
+    SparseGrid old = std::move(*this);
+    _r = r;
+    _c = c;
+    _background = old._background;
+    _tiles.clear();
+    _index.clear();
+    if (retain) {
+      for (const GridLocation &loc : old.nonDefaultLocations()) {
+        if (inBounds(loc))
+          set(loc, old.get(loc));
+      }
+    }
+  }
+
+  int numRows() const { return _r; }
+  int numCols() const { return _c; }
+  bool inBounds(int r, int c) const {
+    return r >= 0 && c >= 0 && r < _r && c < _c;
+  }
+  bool inBounds(const GridLocation &loc) const {
+    return inBounds(loc.row, loc.col);
+  }
+  bool isEmpty() const { return _r == 0 || _c == 0; }
+  long long size() const { return (long long)_r * _c; }
+  const T &background() const { return _background; }
+  // Number of allocated 8x8 tiles
+  int tileCount() const { return _tiles.size(); }
+
+  GridLocationRange locations(bool rowMajor = true) const {
+    if (isEmpty())
+      return GridLocationRange();
+    return GridLocationRange(0, 0, _r - 1, _c - 1, rowMajor);
+  }
+
+  // Locations whose value differs from the background, in row-major order
+  Vector<GridLocation> nonDefaultLocations() const {
+    vector<GridLocation> locs;
+    for (const _Tile &tile : _tiles) {
+      for (uint64_t bits = tile.written; bits; bits &= bits - 1) {
+        int bit = __builtin_ctzll(bits);
+        if (!(tile.cells[bit] == _background))
+          locs.push_back(_location(tile.key, bit));
+      }
+    }
+    std::sort(locs.begin(), locs.end());
+    Vector<GridLocation> result;
+    result.reserve(locs.size());
+    for (const GridLocation &loc : locs)
+      result.add(loc);
+    return result;
+  }
+  template <typename Fn> void mapNonDefault(Fn fn) const {
+    for (const GridLocation &loc : nonDefaultLocations())
+      fn(loc, get(loc));
+  }
+
+  const T &get(int r, int c) const {
+    _checkIndexes(r, c, "get");
+    const _Tile *tile = _findTile(r, c);
+    return tile ? tile->cells[_bit(r, c)] : _background;
+  }
+  const T &get(const GridLocation &loc) const { return get(loc.row, loc.col); }
+
+  // The cell itself, for calling methods on it: grid.cell(r, c).add(x).
+  // Allocates the cell's tile, since the caller may write through it.
+  T &cell(int r, int c) {
+    _checkIndexes(r, c, "cell");
+    return _cell(r, c);
+  }
+  T &cell(const GridLocation &loc) { return cell(loc.row, loc.col); }
+
+  void set(int r, int c, const T &val) {
+    _checkIndexes(r, c, "set");
+    auto it = _index.find(_key(r, c));
+    if (it == _index.end()) {
+      // Writing the background never allocates
+      if (val == _background)
+        return;
+      // val may be a cell of this grid, which adding a tile can move
+      T copy = val;
+      _cell(r, c) = std::move(copy);
+      return;
+    }
+    _Tile &tile = _tiles[it->second];
+    uint64_t bit = uint64_t(1) << _bit(r, c);
+    tile.cells[_bit(r, c)] = val;
+    if (!(val == _background)) {
+      tile.written |= bit;
+      return;
+    }
+    tile.written &= ~bit;
+    if (tile.written == 0)
+      _freeTile(tile.key);
+  }
+  void set(const GridLocation &loc, const T &val) {
+    set(loc.row, loc.col, val);
+  }
+
+  _Row<false> operator[](int r) {
+    if (Checks::check && (r < 0 || r >= _r))
+      error("SparseGrid::operator[]: row index out of range");
+    return _Row<false>(this, r);
+  }
+  _Row<true> operator[](int r) const {
+    if (Checks::check && (r < 0 || r >= _r))
+      error("SparseGrid::operator[]: row index out of range");
+    return _Row<true>(this, r);
+  }
+  CellRef operator[](const GridLocation &loc) {
+    _checkIndexes(loc.row, loc.col, "operator[]");
+    return CellRef(this, loc.row, loc.col);
+  }
+  const T &operator[](const GridLocation &loc) const {
+    return get(loc.row, loc.col);
+  }
+
+  bool equals(const SparseGrid &grid2) const {
+    if (_r != grid2._r || _c != grid2._c)
+      return false;
+    if (!(_background == grid2._background)) {
+      for (const GridLocation &loc : locations()) {
+        if (!(get(loc) == grid2.get(loc)))
+          return false;
+      }
+      return true;
+    }
+    Vector<GridLocation> locs = nonDefaultLocations();
+    if (locs != grid2.nonDefaultLocations())
+      return false;
+    for (const GridLocation &loc : locs) {
+      if (!(get(loc) == grid2.get(loc)))
+        return false;
+    }
+    return true;
+  }
+  bool operator==(const SparseGrid &grid2) const { return equals(grid2); }
+  bool operator!=(const SparseGrid &grid2) const { return !equals(grid2); }
+
+  // Only the non-background cells: {r0c3:x, r7c1:y}
+  string toString() const {
+    stringstream ss;
+    ss << "{";
+    bool first = true;
+    for (const GridLocation &loc : nonDefaultLocations()) {
+      if (!first)
+        ss << ", ";
+      first = false;
+      ss << loc << ":" << get(loc);
+    }
+    ss << "}";
+    return ss.str();
+  }
+  string toDebugString() const {
+    // Enough cells to draw a readable window of the board
+    const int kMaxCells = 400;
+    Vector<GridLocation> locs = nonDefaultLocations();
+    stringstream ss;
+    ss << "{\"__type\": \"SparseGrid\", \"rows\": " << _r
+       << ", \"cols\": " << _c << ", \"tiles\": " << _tiles.size()
+       << ", \"live\": " << locs.size()
+       << ", \"background\": " << _json_val(_background) << ", \"cells\": [";
+    for (int i = 0; i < locs.size() && i < kMaxCells; i++) {
+      ss << (i ? ", " : "") << "[" << locs[i].row << ", " << locs[i].col
+         << ", " << _json_val(get(locs[i])) << "]";
+    }
+    ss << "]}";
+    return ss.str();
+  }
+};
+
+template <typename T, typename Checks>
+ostream &operator<<(ostream &os, const SparseGrid<T, Checks> &g) {
+  os << g.toString();
+  return os;
+}
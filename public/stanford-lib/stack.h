@@ -1,63 +1,194 @@
 #pragma once
 #include "common.h"
+#include <memory>
+
+// The first N elements of a Stack live inside the Stack object itself, so
+// small stacks (recursion simulations, bracket matching) never touch the
+// heap. Past N the elements move to a heap array that doubles as needed.
+
+template <typename T, typename Checks = DefaultChecks, int N = 8>
+class Stack {
+  static_assert(N > 0, "Stack needs at least one inline slot");
 
-template <typename T> class Stack {
 private:
-  vector<T> _v;
+  alignas(T) unsigned char _inline[N * sizeof(T)];
+  T *_data = reinterpret_cast<T *>(_inline);
+  int _size = 0;
+  int _capacity = N;
+
+  bool _isInline() const {
+    return _data == reinterpret_cast<const T *>(_inline);
+  }
+
+  // Moves the elements into storage (the inline buffer when it is null)
+  void _relocate(T *storage, int capacity) {
+    T *data = storage ? storage : reinterpret_cast<T *>(_inline);
+    for (int i = 0; i < _size; i++) {
+      new (&data[i]) T(std::move(_data[i]));
+      _data[i].~T();
+    }
+    if (!_isInline())
+      std::allocator<T>().deallocate(_data, _capacity);
+    _data = data;
+    _capacity = storage ? capacity : N;
+  }
+  void _grow(int capacity) {
+    _relocate(std::allocator<T>().allocate(capacity), capacity);
+  }
+  T *_top() {
+    if (_size == _capacity)
+      _grow(2 * _capacity);
+    return &_data[_size];
+  }
 
 public:
   Stack() {}
-  Stack(std::initializer_list<T> list) : _v(list) {}
-  int size() const { return _v.size(); }
-  bool isEmpty() const { return _v.empty(); }
-  void clear() { _v.clear(); }
-  void push(const T &val) { _v.push_back(val); }
+  Stack(std::initializer_list<T> list) {
+    reserve(list.size());
+    for (const auto &val : list)
+      push(val);
+  }
+  Stack(const Stack &other) {
+    reserve(other._size);
+    for (const auto &val : other)
+      push(val);
+  }
+  Stack(Stack &&other) noexcept { *this = std::move(other); }
+  Stack &operator=(const Stack &other) {
+    if (this != &other) {
+      clear();
+      reserve(other._size);
+      for (const auto &val : other)
+        push(val);
+    }
+    return *this;
+  }
+  Stack &operator=(Stack &&other) noexcept {
+    if (this == &other)
+      return *this;
+    clear();
+    if (other._isInline()) {
+      for (int i = 0; i < other._size; i++)
+        push(std::move(other._data[i]));
+      other.clear();
+    } else {
+      shrinkToFit();
+      _data = other._data;
+      _size = other._size;
+      _capacity = other._capacity;
+      other._data = reinterpret_cast<T *>(other._inline);
+      other._size = 0;
+      other._capacity = N;
+    }
+    return *this;
+  }
+  ~Stack() {
+    clear();
+    if (!_isInline())
+      std::allocator<T>().deallocate(_data, _capacity);
+  }
+
+  int size() const { return _size; }
+  bool isEmpty() const { return _size == 0; }
+  void clear() {
+    for (int i = 0; i < _size; i++)
+      _data[i].~T();
+    _size = 0;
+  }
+  void push(const T &val) { emplace(val); }
+  void push(T &&val) { emplace(std::move(val)); }
+  template <typename... Args> T &emplace(Args &&...args) {
+    if (_size == _capacity) {
+      // args may refer into this stack, whose growing frees the elements
+      T val(std::forward<Args>(args)...);
+      T *slot = _top();
+      new (slot) T(std::move(val));
+      _size++;
+      return *slot;
+    }
+    T *slot = _top();
+    new (slot) T(std::forward<Args>(args)...);
+    _size++;
+    return *slot;
+  }
+  void reserve(int n) {
+    if (Checks::check && n < 0)
+      error("Stack::reserve: negative capacity");
+    if (n > _capacity)
+      _grow(n);
+  }
+  int capacity() const { return _capacity; }
+  void shrinkToFit() {
+    if (_isInline() || _size == _capacity)
+      return;
+    if (_size <= N)
+      _relocate(nullptr, N);
+    else
+      _grow(_size);
+  }
   T pop() {
-    if (isEmpty())
+    if (Checks::check && isEmpty())
       error("Stack::pop: Attempting to pop an empty stack");
-    T val = _v.back();
-    _v.pop_back();
+    T &top = _data[_size - 1];
+    T val = std::move(top);
+    top.~T();
+    _size--;
     return val;
   }
   const T &peek() const {
-    if (isEmpty())
+    if (Checks::check && isEmpty())
       error("Stack::peek: Attempting to peek at an empty stack");
-    return _v.back();
+    return _data[_size - 1];
   }
 
-  bool equals(const Stack<T> &stack2) const { return _v == stack2._v; }
+  bool equals(const Stack &stack2) const { return *this == stack2; }
 
   string toString() const {
     stringstream ss;
     ss << "{";
-    for (size_t i = 0; i < _v.size(); i++)
-      ss << _v[i] << (i < _v.size() - 1 ? ", " : "");
+    for (int i = 0; i < _size; i++)
+      ss << _data[i] << (i < _size - 1 ? ", " : "");
     ss << "}";
     return ss.str();
   }
   string toDebugString() const {
     stringstream ss;
     ss << "[";
-    for (size_t i = 0; i < _v.size(); i++)
-      ss << _json_val(_v[i]) << (i < _v.size() - 1 ? ", " : "");
+    for (int i = 0; i < _size; i++)
+      ss << _json_val(_data[i]) << (i < _size - 1 ? ", " : "");
     ss << "]";
     return ss.str();
   }
 
-  typename vector<T>::iterator begin() { return _v.begin(); }
-  typename vector<T>::iterator end() { return _v.end(); }
-  typename vector<T>::const_iterator begin() const { return _v.begin(); }
-  typename vector<T>::const_iterator end() const { return _v.end(); }
+  T *begin() { return _data; }
+  T *end() { return _data + _size; }
+  const T *begin() const { return _data; }
+  const T *end() const { return _data + _size; }
 
-  bool operator==(const Stack<T> &stack2) const { return _v == stack2._v; }
-  bool operator!=(const Stack<T> &stack2) const { return _v != stack2._v; }
-  bool operator<(const Stack<T> &stack2) const { return _v < stack2._v; }
-  bool operator<=(const Stack<T> &stack2) const { return _v <= stack2._v; }
-  bool operator>(const Stack<T> &stack2) const { return _v > stack2._v; }
-  bool operator>=(const Stack<T> &stack2) const { return _v >= stack2._v; }
+  bool operator==(const Stack &stack2) const {
+    return std::equal(begin(), end(), stack2.begin(), stack2.end());
+  }
+  bool operator!=(const Stack &stack2) const { return !(*this == stack2); }
+  bool operator<(const Stack &stack2) const {
+    return std::lexicographical_compare(begin(), end(), stack2.begin(),
+                                        stack2.end());
+  }
+  bool operator<=(const Stack &stack2) const { return !(stack2 < *this); }
+  bool operator>(const Stack &stack2) const { return stack2 < *this; }
+  bool operator>=(const Stack &stack2) const { return !(*this < stack2); }
 };
 
-template <typename T> ostream &operator<<(ostream &os, const Stack<T> &s) {
+template <typename T, typename Checks, int N>
+ostream &operator<<(ostream &os, const Stack<T, Checks, N> &s) {
   os << s.toString();
   return os;
 }
+
+namespace std {
+template <typename T, typename Checks, int N>
+struct hash<Stack<T, Checks, N>> {
+  size_t operator()(const Stack<T, Checks, N> &s) const {
+    return _hashRange(s.begin(), s.end());
+  }
+};
+} // namespace std
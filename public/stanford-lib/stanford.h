@@ -4,13 +4,21 @@
 // ============================================================
 
 // Data structure headers (include common.h internally)
+#include "combinatorics.h"
+#include "filelib.h"
+#include "graph.h"
 #include "grid.h"
 #include "hashmap.h"
 #include "hashset.h"
+#include "lexicon.h"
 #include "map.h"
 #include "priorityqueue.h"
 #include "queue.h"
+#include "ranges.h"
+#include "sparsegrid.h"
 #include "set.h"
+#include "smallintset.h"
 #include "stack.h"
 #include "strlib.h"
+#include "symbol.h"
 #include "vector.h"
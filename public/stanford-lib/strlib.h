@@ -1,6 +1,13 @@
 #pragma once
 #include "common.h"
 #include "vector.h"
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string_view>
 
 // Prototypes with default arguments where applicable
 string integerToString(int n, int radix = 10);
@@ -8,29 +15,33 @@ string longToString(long n, int radix = 10);
 string realToString(double d);
 string boolToString(bool b);
 string charToString(char c);
-bool stringIsInteger(const string &str, int radix = 10);
-bool stringIsReal(const string &str);
-bool stringIsBool(const string &str);
-int stringToInteger(const string &str, int radix = 10);
-long stringToLong(const string &str, int radix = 10);
-double stringToReal(const string &str);
-bool stringToBool(const string &str);
-char stringToChar(const string &str);
-string toLowerCase(const string &str);
-string toUpperCase(const string &str);
+bool stringIsInteger(std::string_view str, int radix = 10);
+bool stringIsReal(std::string_view str);
+bool stringIsBool(std::string_view str);
+int stringToInteger(std::string_view str, int radix = 10);
+long stringToLong(std::string_view str, int radix = 10);
+double stringToReal(std::string_view str);
+bool stringToBool(std::string_view str);
+char stringToChar(std::string_view str);
+string toLowerCase(std::string_view str);
+string toUpperCase(std::string_view str);
 void toLowerCaseInPlace(string &str);
 void toUpperCaseInPlace(string &str);
-string trim(const string &str);
+string trim(std::string_view str);
 void trimInPlace(string &str);
-string trimStart(const string &str);
+string trimStart(std::string_view str);
 void trimStartInPlace(string &str);
-string trimEnd(const string &str);
+string trimEnd(std::string_view str);
 void trimEndInPlace(string &str);
-bool startsWith(const string &str, const string &prefix);
-bool startsWith(const string &str, char prefix);
-bool endsWith(const string &str, const string &suffix);
-bool endsWith(const string &str, char suffix);
-bool equalsIgnoreCase(const string &s1, const string &s2);
+// Sub-ranges of str, without copying; str must outlive the result
+std::string_view trimView(std::string_view str);
+std::string_view trimStartView(std::string_view str);
+std::string_view trimEndView(std::string_view str);
+bool startsWith(std::string_view str, std::string_view prefix);
+bool startsWith(std::string_view str, char prefix);
+bool endsWith(std::string_view str, std::string_view suffix);
+bool endsWith(std::string_view str, char suffix);
+bool equalsIgnoreCase(std::string_view s1, std::string_view s2);
 string stringReplace(const string &str, const string &old,
                      const string &replacement, int limit = -1);
 string stringReplace(const string &str, char old, char replacement,
@@ -42,20 +53,27 @@ int stringReplaceInPlace(string &str, char old, char replacement,
 Vector<string> stringSplit(const string &str, const string &delimiter,
                            int limit = -1);
 Vector<string> stringSplit(const string &str, char delimiter, int limit = -1);
+// Splits at any one of the delimiter characters
+Vector<string> stringSplitAny(const string &str, const string &delimiters,
+                              int limit = -1);
+// Splits at runs of whitespace, ignoring leading and trailing whitespace
+Vector<string> stringSplitWhitespace(const string &str);
 string stringJoin(const Vector<string> &v, const string &delimiter = "");
 string stringJoin(const Vector<string> &v, char delimiter);
 string htmlDecode(const string &s);
 string htmlEncode(const string &s);
-string urlDecode(const string &str);
+string urlDecode(std::string_view str);
 void urlDecodeInPlace(string &str);
-string urlEncode(const string &str);
+string urlEncode(std::string_view str);
 void urlEncodeInPlace(string &str);
-bool stringContains(const string &s, char ch);
-bool stringContains(const string &s, const string &substring);
-int stringIndexOf(const string &s, char ch, int startIndex = 0);
-int stringIndexOf(const string &s, const string &substring, int startIndex = 0);
-int stringLastIndexOf(const string &s, char ch, int startIndex = string::npos);
-int stringLastIndexOf(const string &s, const string &substring,
+bool stringContains(std::string_view s, char ch);
+bool stringContains(std::string_view s, std::string_view substring);
+int stringIndexOf(std::string_view s, char ch, int startIndex = 0);
+int stringIndexOf(std::string_view s, std::string_view substring,
+                  int startIndex = 0);
+int stringLastIndexOf(std::string_view s, char ch,
+                      int startIndex = string::npos);
+int stringLastIndexOf(std::string_view s, std::string_view substring,
                       int startIndex = string::npos);
 
 // ============================================================
@@ -69,9 +87,9 @@ char integerToChar(int n);
 
 // Aliases for real/double naming consistency
 string doubleToString(double d);
-double stringToDouble(const string &str);
-bool stringIsDouble(const string &str);
-bool stringIsLong(const string &str, int radix = 10);
+double stringToDouble(std::string_view str);
+bool stringIsDouble(std::string_view str);
+bool stringIsLong(std::string_view str, int radix = 10);
 
 // Pointer to hex string
 string pointerToString(void *p);
@@ -80,6 +98,237 @@ string pointerToString(void *p);
 char toLowerCase(char ch);
 char toUpperCase(char ch);
 
+// ============================================================
+// Lazy splitting
+// ============================================================
+// for (string_view field : splitView(line, ',')) ...
+// yields the same tokens as stringSplit, as views into the original
+// text, finding each one only when the loop reaches it. Nothing is
+// copied or allocated, so the text must outlive the loop.
+
+class StringSplitView {
+public:
+  enum class Mode { Delimiter, Char, AnyOf, Whitespace };
+
+private:
+  std::string_view _text, _delims;
+  char _ch;
+  Mode _mode;
+
+public:
+  // Splitting state; next() moves the next token out of rest
+  struct Cursor {
+    std::string_view rest;
+    bool done = false;
+
+    bool next(const StringSplitView &view, std::string_view &token) {
+      if (done)
+        return false;
+      if (view._mode == Mode::Whitespace) {
+        size_t start = 0;
+        while (start < rest.size() && isspace((unsigned char)rest[start]))
+          start++;
+        size_t end = start;
+        while (end < rest.size() && !isspace((unsigned char)rest[end]))
+          end++;
+        token = rest.substr(start, end - start);
+        rest.remove_prefix(end);
+        done = token.empty();
+        return !done;
+      }
+      size_t pos, skip = 1;
+      if (view._mode == Mode::Char) {
+        pos = rest.find(view._ch);
+      } else if (view._delims.empty()) {
+        pos = string::npos;
+      } else if (view._mode == Mode::AnyOf) {
+        pos = rest.find_first_of(view._delims);
+      } else {
+        pos = rest.find(view._delims);
+        skip = view._delims.size();
+      }
+      if (pos == string::npos) {
+        token = rest;
+        rest = std::string_view();
+        done = true;
+      } else {
+        token = rest.substr(0, pos);
+        rest.remove_prefix(pos + skip);
+      }
+      return true;
+    }
+  };
+
+  class iterator {
+  private:
+    const StringSplitView *_view;
+    Cursor _cursor;
+    std::string_view _token;
+    bool _end;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = const std::string_view &;
+
+    iterator(const StringSplitView *view, bool end)
+        : _view(view), _cursor{view->_text}, _end(end) {
+      if (!_end)
+        ++*this;
+    }
+    const std::string_view &operator*() const { return _token; }
+    const std::string_view *operator->() const { return &_token; }
+    iterator &operator++() {
+      _end = !_cursor.next(*_view, _token);
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const iterator &other) const {
+      return _end == other._end &&
+             (_end || _token.data() == other._token.data());
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+  };
+
+  StringSplitView(std::string_view text, std::string_view delims, char ch,
+                  Mode mode)
+      : _text(text), _delims(delims), _ch(ch), _mode(mode) {}
+  iterator begin() const { return iterator(this, false); }
+  iterator end() const { return iterator(this, true); }
+  Cursor cursor() const { return Cursor{_text}; }
+  // Copies the tokens, as stringSplit would
+  Vector<string> toVector() const {
+    Vector<string> result;
+    for (std::string_view token : *this)
+      result.add(string(token));
+    return result;
+  }
+};
+
+StringSplitView splitView(std::string_view str, std::string_view delimiter) {
+  return StringSplitView(str, delimiter, 0,
+                         StringSplitView::Mode::Delimiter);
+}
+StringSplitView splitView(std::string_view str, char delimiter) {
+  return StringSplitView(str, {}, delimiter, StringSplitView::Mode::Char);
+}
+StringSplitView splitViewAny(std::string_view str,
+                             std::string_view delimiters) {
+  return StringSplitView(str, delimiters, 0, StringSplitView::Mode::AnyOf);
+}
+StringSplitView splitViewWhitespace(std::string_view str) {
+  return StringSplitView(str, {}, 0, StringSplitView::Mode::Whitespace);
+}
+
+// ============================================================
+// Multi-pattern replacement
+// ============================================================
+// Replaces several patterns in one left-to-right scan:
+//   stringReplaceAll(text, {{"cat", "dog"}, {"dog", "cat"}})
+// swaps cats and dogs. Where patterns overlap the longest one wins, and
+// replaced text is never scanned again. Any range of (from, to) pairs
+// works as the table, such as a Map<string, string>. Build a
+// StringReplacer once to reuse the same table on many strings.
+
+class StringReplacer {
+private:
+  // Sorted by first byte, longest first; the rules starting with byte b
+  // are _rules[_start[b]] up to _rules[_start[b + 1]]
+  vector<std::pair<string, string>> _rules;
+  int _start[257] = {};
+
+  void _index() {
+    std::sort(_rules.begin(), _rules.end(), [](const auto &a, const auto &b) {
+      unsigned char ca = a.first[0], cb = b.first[0];
+      return ca != cb ? ca < cb : a.first.size() > b.first.size();
+    });
+    for (const auto &rule : _rules)
+      _start[(unsigned char)rule.first[0] + 1]++;
+    for (int b = 0; b < 256; b++)
+      _start[b + 1] += _start[b];
+  }
+  // The rule matching text at i, or nullptr
+  const std::pair<string, string> *_match(std::string_view text,
+                                          size_t i) const {
+    unsigned char b = text[i];
+    for (int r = _start[b]; r < _start[b + 1]; r++) {
+      const string &from = _rules[r].first;
+      if (text.compare(i, from.size(), from) == 0)
+        return &_rules[r];
+    }
+    return nullptr;
+  }
+
+public:
+  StringReplacer(std::initializer_list<std::pair<string, string>> table)
+      : StringReplacer(vector<std::pair<string, string>>(table)) {}
+  template <typename Table> explicit StringReplacer(const Table &table) {
+    for (const auto &[from, to] : table) {
+      if (!from.empty())
+        _rules.emplace_back(from, to);
+    }
+    _index();
+  }
+
+  // First counts the output's length, then writes it into a string of
+  // exactly that size, so the cost is linear in the text
+  string replace(std::string_view text, int *count = nullptr) const {
+    size_t length = 0;
+    int hits = 0;
+    for (size_t i = 0; i < text.size();) {
+      const auto *rule = _match(text, i);
+      if (rule) {
+        length += rule->second.size();
+        i += rule->first.size();
+        hits++;
+      } else {
+        length++;
+        i++;
+      }
+    }
+    if (count)
+      *count = hits;
+    if (hits == 0)
+      return string(text);
+    string result(length, '\0');
+    char *out = &result[0];
+    for (size_t i = 0; i < text.size();) {
+      const auto *rule = _match(text, i);
+      if (rule) {
+        out = std::copy(rule->second.begin(), rule->second.end(), out);
+        i += rule->first.size();
+      } else {
+        *out++ = text[i++];
+      }
+    }
+    return result;
+  }
+  // Returns the number of replacements
+  int replaceInPlace(string &str) const {
+    int count;
+    string result = replace(str, &count);
+    if (count)
+      str.swap(result);
+    return count;
+  }
+};
+
+template <typename Table>
+string stringReplaceAll(const string &str, const Table &replacements) {
+  return StringReplacer(replacements).replace(str);
+}
+string stringReplaceAll(
+    const string &str,
+    std::initializer_list<std::pair<string, string>> replacements) {
+  return StringReplacer(replacements).replace(str);
+}
+
 // ============================================================
 // std:: namespace extensions
 // ============================================================
@@ -97,33 +346,246 @@ string to_string(void *p);
 
 string boolToString(bool b) { return (b ? "true" : "false"); }
 
+/*
+ * Implementation notes: byte-parallel kernels
+ * Case conversion, trimming and searching test 8 bytes at a time: each
+ * 64-bit word is checked with carry-free arithmetic (SWAR) that sets the
+ * high bit of every byte meeting a condition, and a count of trailing
+ * zero bits turns that mask into a position. Shorter tails go a byte at
+ * a time. The results are exactly those of tolower, toupper and isspace
+ * in the C locale; bytes outside ASCII are never changed or matched.
+ */
+const uint64_t _kOnes = 0x0101010101010101ULL;
+const uint64_t _kHighs = 0x8080808080808080ULL;
+
+uint64_t _load8(const char *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+void _store8(char *p, uint64_t v) { memcpy(p, &v, 8); }
+
+// Position of the first/last byte flagged in a nonzero mask
+// (little-endian, as on wasm and x86)
+size_t _firstByte(uint64_t mask) { return __builtin_ctzll(mask) >> 3; }
+size_t _lastByte(uint64_t mask) { return (63 - __builtin_clzll(mask)) >> 3; }
+
+uint64_t _zeroBytes(uint64_t v) {
+  return ~(((v & ~_kHighs) + ~_kHighs) | v | ~_kHighs);
+}
+
+uint64_t _bytesEqual(uint64_t v, char ch) {
+  return _zeroBytes(v ^ (_kOnes * (unsigned char)ch));
+}
+
+// Bytes in [lo, hi], for lo <= hi < 0x80
+uint64_t _bytesInRange(uint64_t v, unsigned char lo, unsigned char hi) {
+  uint64_t low = v & ~_kHighs;
+  uint64_t atLeastLo = low + _kOnes * (0x80 - lo);
+  uint64_t aboveHi = low + _kOnes * (0x7F - hi);
+  return atLeastLo & ~aboveHi & ~v & _kHighs;
+}
+
+uint64_t _spaceBytes(uint64_t v) {
+  return _bytesInRange(v, '\t', '\r') | _bytesEqual(v, ' ');
+}
+
+uint64_t _lowerWord(uint64_t v) { return v | _bytesInRange(v, 'A', 'Z') >> 2; }
+
+uint64_t _upperWord(uint64_t v) {
+  return v & ~(_bytesInRange(v, 'a', 'z') >> 2);
+}
+
+bool _isSpaceByte(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+
+char _lowerByte(char ch) { return ch >= 'A' && ch <= 'Z' ? ch + 32 : ch; }
+
+void _lowerBytes(char *p, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _store8(p + i, _lowerWord(_load8(p + i)));
+  for (; i < n; i++)
+    p[i] = _lowerByte(p[i]);
+}
+
+void _upperBytes(char *p, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _store8(p + i, _upperWord(_load8(p + i)));
+  for (; i < n; i++)
+    p[i] = p[i] >= 'a' && p[i] <= 'z' ? p[i] - 32 : p[i];
+}
+
+// Number of whitespace bytes at the start of [p, p + n)
+size_t _leadingSpaces(const char *p, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t other = ~_spaceBytes(_load8(p + i)) & _kHighs;
+    if (other)
+      return i + _firstByte(other);
+  }
+  while (i < n && _isSpaceByte(p[i]))
+    i++;
+  return i;
+}
+
+// Number of whitespace bytes at the end of [p, p + n)
+size_t _trailingSpaces(const char *p, size_t n) {
+  size_t end = n;
+  for (; end >= 8; end -= 8) {
+    uint64_t other = ~_spaceBytes(_load8(p + end - 8)) & _kHighs;
+    if (other)
+      return n - (end - 8 + _lastByte(other) + 1);
+  }
+  while (end > 0 && _isSpaceByte(p[end - 1]))
+    end--;
+  return n - end;
+}
+
+bool _equalBytesIgnoreCase(const char *a, const char *b, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t x = _load8(a + i), y = _load8(b + i);
+    if (x != y && _lowerWord(x) != _lowerWord(y))
+      return false;
+  }
+  for (; i < n; i++) {
+    if (_lowerByte(a[i]) != _lowerByte(b[i]))
+      return false;
+  }
+  return true;
+}
+
+// Index of the first ch in [p + start, p + n), or npos
+size_t _findByte(const char *p, size_t n, char ch, size_t start) {
+  size_t i = start;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t found = _bytesEqual(_load8(p + i), ch);
+    if (found)
+      return i + _firstByte(found);
+  }
+  for (; i < n; i++) {
+    if (p[i] == ch)
+      return i;
+  }
+  return string::npos;
+}
+
+// Index of the first needle at or after start, or npos. Candidate
+// positions must match the needle's first and last bytes, which are
+// checked for 8 positions at once before comparing the rest.
+size_t _findBytes(const char *p, size_t n, const char *needle, size_t m,
+                  size_t start) {
+  if (start > n || m > n - start)
+    return m == 0 && start <= n ? start : string::npos;
+  if (m == 0)
+    return start;
+  if (m == 1)
+    return _findByte(p, n, needle[0], start);
+  size_t last = n - m; // last possible match position
+  size_t i = start;
+  for (; i + 8 <= last + 1; i += 8) {
+    uint64_t candidates = _bytesEqual(_load8(p + i), needle[0]) &
+                          _bytesEqual(_load8(p + i + m - 1), needle[m - 1]);
+    for (; candidates; candidates &= candidates - 1) {
+      size_t pos = i + _firstByte(candidates);
+      if (memcmp(p + pos + 1, needle + 1, m - 2) == 0)
+        return pos;
+    }
+  }
+  for (; i <= last; i++) {
+    if (p[i] == needle[0] && memcmp(p + i + 1, needle + 1, m - 1) == 0)
+      return i;
+  }
+  return string::npos;
+}
+
 /*
  * Implementation notes: numeric conversion
+ * The conversions parse and print in place with from_chars, to_chars and
+ * the C number functions instead of building a string stream and a
+ * trimmed copy of the text for every call. They accept what the stream
+ * versions accepted: surrounding whitespace, a leading + or -, and for
+ * radix 16 an optional 0x prefix. The whole remaining text must be one
+ * number that fits the type.
  */
+void _trimmedRange(std::string_view str, const char *&first,
+                   const char *&last) {
+  first = str.data();
+  last = first + str.size();
+  first += _leadingSpaces(first, last - first);
+  last -= _trailingSpaces(first, last - first);
+}
+
+template <typename T>
+bool _parseInteger(std::string_view str, int radix, T &value) {
+  const char *first, *last;
+  _trimmedRange(str, first, last);
+  bool negative = first < last && *first == '-';
+  if (first < last && (*first == '-' || *first == '+'))
+    first++;
+  if (radix == 16 && last - first > 2 && first[0] == '0' &&
+      (first[1] == 'x' || first[1] == 'X'))
+    first += 2;
+  unsigned long long magnitude;
+  auto [end, ec] = std::from_chars(first, last, magnitude, radix);
+  if (ec != std::errc() || end != last)
+    return false;
+  unsigned long long limit = std::numeric_limits<T>::max();
+  if (magnitude > limit + negative)
+    return false;
+  value = negative ? (T)(0 - magnitude) : (T)magnitude;
+  return true;
+}
+
+bool _parseReal(std::string_view str, double &value) {
+  const char *first, *last;
+  _trimmedRange(str, first, last);
+  // strtod also reads inf, nan and hex floats, which streams reject
+  for (const char *p = first; p < last; p++) {
+    if (!isdigit((unsigned char)*p) && (!*p || !strchr("+-.eE", *p)))
+      return false;
+  }
+  if (first == last)
+    return false;
+  string text(first, last); // strtod needs a terminated string
+  char *end;
+  value = strtod(text.c_str(), &end);
+  return end == text.c_str() + text.size() && value != HUGE_VAL &&
+         value != -HUGE_VAL;
+}
+
+// Radixes 8 and 16 print the two's complement bits of negative numbers,
+// as the stream versions did
+template <typename T> string _integerToString(T n, int radix) {
+  char buffer[sizeof(T) * 8 + 1];
+  std::to_chars_result result;
+  if (radix == 8 || radix == 16)
+    result = std::to_chars(buffer, std::end(buffer),
+                           (std::make_unsigned_t<T>)n, radix);
+  else
+    result = std::to_chars(buffer, std::end(buffer), n, radix);
+  return string(buffer, result.ptr);
+}
+
 string integerToString(int n, int radix) {
-  if (radix <= 0)
+  if (radix < 2 || radix > 36)
     error("integerToString: Illegal radix");
-  ostringstream stream;
-  if (radix != 10)
-    stream << setbase(radix);
-  stream << n;
-  return stream.str();
+  return _integerToString(n, radix);
 }
 
 string longToString(long n, int radix) {
-  if (radix <= 0)
+  if (radix < 2 || radix > 36)
     error("longToString: Illegal radix");
-  ostringstream stream;
-  if (radix != 10)
-    stream << setbase(radix);
-  stream << n;
-  return stream.str();
+  return _integerToString(n, radix);
 }
 
 string realToString(double d) {
-  ostringstream stream;
-  stream << uppercase << d;
-  return stream.str();
+  // What ostream << uppercase << d prints
+  char buffer[32];
+  int length = snprintf(buffer, sizeof(buffer), "%G", d);
+  return string(buffer, length);
 }
 
 string charToString(char c) {
@@ -132,59 +594,48 @@ string charToString(char c) {
   return s;
 }
 
-bool stringIsInteger(const string &str, int radix) {
-  if (radix <= 0)
+bool stringIsInteger(std::string_view str, int radix) {
+  if (radix < 2 || radix > 36)
     error("stringIsInteger: Illegal radix");
-  istringstream stream(trim(str));
-  stream >> setbase(radix);
   int value;
-  stream >> value;
-  return !(stream.fail() || !stream.eof());
+  return _parseInteger(str, radix, value);
 }
 
-bool stringIsReal(const string &str) {
-  istringstream stream(trim(str));
+bool stringIsReal(std::string_view str) {
   double value;
-  stream >> value;
-  return !(stream.fail() || !stream.eof());
+  return _parseReal(str, value);
 }
 
-bool stringIsBool(const string &str) { return str == "true" || str == "false"; }
+bool stringIsBool(std::string_view str) {
+  return str == "true" || str == "false";
+}
 
-int stringToInteger(const string &str, int radix) {
-  if (radix <= 0)
+int stringToInteger(std::string_view str, int radix) {
+  if (radix < 2 || radix > 36)
     error("stringToInteger: Illegal radix");
-  istringstream stream(trim(str));
-  stream >> setbase(radix);
   int value;
-  stream >> value;
-  if (stream.fail() || !stream.eof())
+  if (!_parseInteger(str, radix, value))
     error("stringToInteger: Illegal integer format");
   return value;
 }
 
-long stringToLong(const string &str, int radix) {
-  if (radix <= 0)
+long stringToLong(std::string_view str, int radix) {
+  if (radix < 2 || radix > 36)
     error("stringToLong: Illegal radix");
-  istringstream stream(trim(str));
-  stream >> setbase(radix);
   long value;
-  stream >> value;
-  if (stream.fail() || !stream.eof())
+  if (!_parseInteger(str, radix, value))
     error("stringToLong: Illegal long format");
   return value;
 }
 
-double stringToReal(const string &str) {
-  istringstream stream(trim(str));
+double stringToReal(std::string_view str) {
   double value;
-  stream >> value;
-  if (stream.fail() || !stream.eof())
+  if (!_parseReal(str, value))
     error("stringToReal: Illegal floating-point format");
   return value;
 }
 
-bool stringToBool(const string &str) {
+bool stringToBool(std::string_view str) {
   if (str == "true" || str == "1")
     return true;
   if (str == "false" || str == "0")
@@ -197,112 +648,118 @@ bool stringToBool(const string &str) {
   return value;
 }
 
-char stringToChar(const string &str) {
+char stringToChar(std::string_view str) {
   if (str.length() != 1)
     error("stringToChar: string must contain exactly 1 character");
   return str[0];
 }
 
-void toLowerCaseInPlace(string &str) {
-  for (size_t i = 0; i < str.length(); i++)
-    str[i] = tolower(str[i]);
-}
+void toLowerCaseInPlace(string &str) { _lowerBytes(&str[0], str.size()); }
 
-string toLowerCase(const string &str) {
-  string s = str;
+string toLowerCase(std::string_view str) {
+  string s(str);
   toLowerCaseInPlace(s);
   return s;
 }
 
-void toUpperCaseInPlace(string &str) {
-  for (size_t i = 0; i < str.length(); i++)
-    str[i] = toupper(str[i]);
-}
+void toUpperCaseInPlace(string &str) { _upperBytes(&str[0], str.size()); }
 
-string toUpperCase(const string &str) {
-  string s = str;
+string toUpperCase(std::string_view str) {
+  string s(str);
   toUpperCaseInPlace(s);
   return s;
 }
 
 void trimEndInPlace(string &str) {
-  int finish = (int)str.length();
-  while (finish > 0 && isspace(str[finish - 1]))
-    finish--;
-  if (finish < (int)str.length())
-    str.erase(finish);
+  size_t trailing = _trailingSpaces(str.data(), str.size());
+  if (trailing > 0)
+    str.erase(str.size() - trailing);
 }
 
-string trimEnd(const string &str) {
-  string s = str;
-  trimEndInPlace(s);
-  return s;
+std::string_view trimEndView(std::string_view str) {
+  return str.substr(0, str.size() - _trailingSpaces(str.data(), str.size()));
 }
 
+string trimEnd(std::string_view str) { return string(trimEndView(str)); }
+
 void trimStartInPlace(string &str) {
-  int start = 0;
-  while (start < (int)str.length() && isspace(str[start]))
-    start++;
-  if (start > 0)
-    str.erase(0, start);
+  size_t leading = _leadingSpaces(str.data(), str.size());
+  if (leading > 0)
+    str.erase(0, leading);
 }
 
-string trimStart(const string &str) {
-  string s = str;
-  trimStartInPlace(s);
-  return s;
+std::string_view trimStartView(std::string_view str) {
+  return str.substr(_leadingSpaces(str.data(), str.size()));
 }
 
+string trimStart(std::string_view str) { return string(trimStartView(str)); }
+
 void trimInPlace(string &str) {
   trimEndInPlace(str);
   trimStartInPlace(str);
 }
 
-string trim(const string &str) {
-  string s = str;
-  trimInPlace(s);
-  return s;
+std::string_view trimView(std::string_view str) {
+  return trimStartView(trimEndView(str));
 }
 
-bool startsWith(const string &str, const string &prefix) {
+string trim(std::string_view str) { return string(trimView(str)); }
+
+bool startsWith(std::string_view str, std::string_view prefix) {
   return str.size() >= prefix.size() && str.substr(0, prefix.size()) == prefix;
 }
 
-bool startsWith(const string &str, char prefix) {
+bool startsWith(std::string_view str, char prefix) {
   return !str.empty() && str[0] == prefix;
 }
 
-bool endsWith(const string &str, const string &suffix) {
+bool endsWith(std::string_view str, std::string_view suffix) {
   return str.size() >= suffix.size() &&
          str.substr(str.size() - suffix.size()) == suffix;
 }
 
-bool endsWith(const string &str, char suffix) {
+bool endsWith(std::string_view str, char suffix) {
   return !str.empty() && str.back() == suffix;
 }
 
-bool equalsIgnoreCase(const string &s1, const string &s2) {
-  if (s1.size() != s2.size())
-    return false;
-  for (size_t i = 0; i < s1.size(); i++) {
-    if (tolower(s1[i]) != tolower(s2[i]))
-      return false;
-  }
-  return true;
+bool equalsIgnoreCase(std::string_view s1, std::string_view s2) {
+  return s1.size() == s2.size() &&
+         _equalBytesIgnoreCase(s1.data(), s2.data(), s1.size());
 }
 
+/*
+ * Implementation notes: stringReplaceInPlace
+ * Matches are found left to right and never overlap. The first pass
+ * finds them (overwriting them directly when old and replacement have
+ * the same length); otherwise a second pass copies the text into a
+ * string of the final size, instead of shifting the tail at every match.
+ * An empty old string matches nothing.
+ */
 int stringReplaceInPlace(string &str, const string &old,
                          const string &replacement, int limit) {
+  if (old.empty())
+    return 0;
+  bool sameLength = old.size() == replacement.size();
   int count = 0;
+  for (size_t pos = str.find(old); pos != string::npos && count != limit;
+       pos = str.find(old, pos + old.size())) {
+    if (sameLength)
+      str.replace(pos, old.size(), replacement);
+    count++;
+  }
+  if (count == 0 || sameLength)
+    return count;
+  string result;
+  result.reserve(str.size() + count * (replacement.size() - old.size()));
   size_t start = 0;
-  while (limit < 0 || count < limit) {
+  for (int i = 0; i < count; i++) {
     size_t pos = str.find(old, start);
-    if (pos == string::npos)
-      break;
-    str.replace(pos, old.length(), replacement);
-    start = pos + replacement.length();
-    count++;
+    result.append(str, start, pos - start);
+    result += replacement;
+    start = pos + old.size();
   }
+  result.append(str, start, string::npos);
+  str.swap(result);
   return count;
 }
 
@@ -332,28 +789,43 @@ string stringReplace(const string &str, char old, char replacement, int limit) {
   return s;
 }
 
-Vector<string> stringSplit(const string &str, const string &delimiter,
-                           int limit) {
+/*
+ * Implementation notes: stringSplit
+ * Each token is copied once, straight out of str: the scan moves forward
+ * from one delimiter to the next, so splitting is linear in str's length.
+ * After limit splits, the rest of str is the last token.
+ */
+Vector<string> _stringSplit(const StringSplitView &view, int limit) {
   Vector<string> result;
-  if (delimiter.empty()) {
-    result.add(str);
-    return result;
-  }
-  string s = str;
-  size_t pos = 0;
-  int count = 0;
-  while ((limit < 0 || count < limit) &&
-         (pos = s.find(delimiter)) != string::npos) {
-    result.add(s.substr(0, pos));
-    s.erase(0, pos + delimiter.length());
-    count++;
+  StringSplitView::Cursor cursor = view.cursor();
+  std::string_view token;
+  for (int count = 0; !cursor.done; count++) {
+    if (count == limit) {
+      result.add(string(cursor.rest));
+      break;
+    }
+    if (cursor.next(view, token))
+      result.add(string(token));
   }
-  result.add(s);
   return result;
 }
 
+Vector<string> stringSplit(const string &str, const string &delimiter,
+                           int limit) {
+  return _stringSplit(splitView(str, delimiter), limit);
+}
+
 Vector<string> stringSplit(const string &str, char delimiter, int limit) {
-  return stringSplit(str, string(1, delimiter), limit);
+  return _stringSplit(splitView(str, delimiter), limit);
+}
+
+Vector<string> stringSplitAny(const string &str, const string &delimiters,
+                              int limit) {
+  return _stringSplit(splitViewAny(str, delimiters), limit);
+}
+
+Vector<string> stringSplitWhitespace(const string &str) {
+  return splitViewWhitespace(str).toVector();
 }
 
 string stringJoin(const Vector<string> &v, const string &delimiter) {
@@ -370,25 +842,30 @@ string stringJoin(const Vector<string> &v, char delimiter) {
   return stringJoin(v, string(1, delimiter));
 }
 
-bool stringContains(const string &s, const string &substring) {
-  return s.find(substring) != string::npos;
+bool stringContains(std::string_view s, std::string_view substring) {
+  return _findBytes(s.data(), s.size(), substring.data(), substring.size(),
+                    0) != string::npos;
 }
 
-bool stringContains(const string &s, char ch) {
-  return s.find(ch) != string::npos;
+bool stringContains(std::string_view s, char ch) {
+  return _findByte(s.data(), s.size(), ch, 0) != string::npos;
 }
 
-int stringIndexOf(const string &s, const string &substring, int startIndex) {
-  size_t pos = s.find(substring, startIndex);
+int stringIndexOf(std::string_view s, std::string_view substring,
+                  int startIndex) {
+  size_t pos = _findBytes(s.data(), s.size(), substring.data(),
+                          substring.size(), (size_t)startIndex);
   return (pos == string::npos) ? -1 : (int)pos;
 }
 
-int stringIndexOf(const string &s, char ch, int startIndex) {
-  size_t pos = s.find(ch, startIndex);
+int stringIndexOf(std::string_view s, char ch, int startIndex) {
+  if (startIndex < 0)
+    return -1;
+  size_t pos = _findByte(s.data(), s.size(), ch, startIndex);
   return (pos == string::npos) ? -1 : (int)pos;
 }
 
-int stringLastIndexOf(const string &s, const string &substring,
+int stringLastIndexOf(std::string_view s, std::string_view substring,
                       int startIndex) {
   size_t pos =
       s.rfind(substring,
@@ -396,77 +873,128 @@ int stringLastIndexOf(const string &s, const string &substring,
   return (pos == string::npos) ? -1 : (int)pos;
 }
 
-int stringLastIndexOf(const string &s, char ch, int startIndex) {
+int stringLastIndexOf(std::string_view s, char ch, int startIndex) {
   size_t pos = s.rfind(ch, (startIndex == string::npos) ? string::npos
                                                         : (size_t)startIndex);
   return (pos == string::npos) ? -1 : (int)pos;
 }
 
 string htmlEncode(const string &s) {
-  string res = s;
-  stringReplaceInPlace(res, "&", "&amp;");
-  stringReplaceInPlace(res, "<", "&lt;");
-  stringReplaceInPlace(res, ">", "&gt;");
-  stringReplaceInPlace(res, "\"", "&quot;");
-  return res;
+  static const StringReplacer entities = {
+      {"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}};
+  return entities.replace(s);
 }
 
 string htmlDecode(const string &s) {
-  string res = s;
-  stringReplaceInPlace(res, "&lt;", "<");
-  stringReplaceInPlace(res, "&gt;", ">");
-  stringReplaceInPlace(res, "&quot;", "\"");
-  stringReplaceInPlace(res, "&amp;", "&");
-  return res;
+  static const StringReplacer entities = {
+      {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&amp;", "&"}};
+  return entities.replace(s);
 }
 
 // Minimal URL encode/decode
-string urlEncode(const string &str) {
-  ostringstream escaped;
-  escaped.fill('0');
-  escaped << hex << uppercase;
+/*
+ * Implementation notes: URL encoding
+ * Both directions are single passes over the text. Encoding looks each
+ * byte up in a table and writes into a string already sized for the
+ * result; the in-place version fills the string from the back, so bytes
+ * are moved once and the buffer is reused. Decoding never lengthens the
+ * text, so it writes over its input. A % followed by two hex digits is
+ * decoded; any other % is kept as is.
+ */
+// The character each byte encodes to, or 0 if it needs a %XX escape
+const std::array<char, 256> &_urlEncodeTable() {
+  static const std::array<char, 256> table = [] {
+    std::array<char, 256> t{};
+    for (int c = 0; c < 128; c++) {
+      if (isalnum(c) || (c && strchr("-_.~*", c)))
+        t[c] = c;
+    }
+    t[' '] = '+';
+    return t;
+  }();
+  return table;
+}
+
+size_t _urlEncodedSize(std::string_view str) {
+  const std::array<char, 256> &table = _urlEncodeTable();
+  size_t size = str.size();
   for (char c : str) {
-    if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' ||
-        c == '*') {
-      escaped << c;
-    } else if (c == ' ') {
-      escaped << '+';
+    if (!table[(unsigned char)c])
+      size += 2;
+  }
+  return size;
+}
+
+// Writes the encoding of str backwards, ending just before end
+void _urlEncodeBackward(std::string_view str, char *end) {
+  const std::array<char, 256> &table = _urlEncodeTable();
+  const char *hex = "0123456789ABCDEF";
+  for (size_t i = str.size(); i-- > 0;) {
+    unsigned char c = str[i];
+    if (table[c]) {
+      *--end = table[c];
     } else {
-      escaped << '%' << setw(2) << (int)(unsigned char)c << setw(0);
+      *--end = hex[c & 15];
+      *--end = hex[c >> 4];
+      *--end = '%';
     }
   }
-  return escaped.str();
-}
-
-void urlEncodeInPlace(string &str) { str = urlEncode(str); }
-
-string urlDecode(const string &str) {
-  // simplified for brevity
-  string res;
-  for (size_t i = 0; i < str.length(); ++i) {
-    if (str[i] == '%') {
-      if (i + 2 < str.length()) {
-        int val;
-        istringstream is(str.substr(i + 1, 2));
-        if (is >> hex >> val) {
-          res += (char)val;
-          i += 2;
-        } else {
-          res += '%';
-        }
-      } else {
-        res += '%';
+}
+
+string urlEncode(std::string_view str) {
+  string result(_urlEncodedSize(str), '\0');
+  _urlEncodeBackward(str, &result[0] + result.size());
+  return result;
+}
+
+void urlEncodeInPlace(string &str) {
+  size_t length = str.size();
+  size_t size = _urlEncodedSize(str);
+  if (size == length) {
+    for (char &c : str)
+      c = c == ' ' ? '+' : c;
+    return;
+  }
+  str.resize(size);
+  _urlEncodeBackward(std::string_view(str.data(), length), &str[0] + size);
+}
+
+int _hexDigitValue(char ch) {
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+  ch |= 0x20;
+  return ch >= 'a' && ch <= 'f' ? ch - 'a' + 10 : -1;
+}
+
+// Decodes [in, in + n) into out, which may be in itself; returns the
+// decoded length
+size_t _urlDecodeInto(const char *in, size_t n, char *out) {
+  size_t w = 0;
+  for (size_t i = 0; i < n; i++) {
+    char c = in[i];
+    if (c == '+') {
+      c = ' ';
+    } else if (c == '%' && i + 2 < n) {
+      int high = _hexDigitValue(in[i + 1]), low = _hexDigitValue(in[i + 2]);
+      if (high >= 0 && low >= 0) {
+        c = (char)(high << 4 | low);
+        i += 2;
       }
-    } else if (str[i] == '+') {
-      res += ' ';
-    } else {
-      res += str[i];
     }
+    out[w++] = c;
   }
-  return res;
+  return w;
 }
 
-void urlDecodeInPlace(string &str) { str = urlDecode(str); }
+string urlDecode(std::string_view str) {
+  string result(str.size(), '\0');
+  result.resize(_urlDecodeInto(str.data(), str.size(), &result[0]));
+  return result;
+}
+
+void urlDecodeInPlace(string &str) {
+  str.resize(_urlDecodeInto(str.data(), str.size(), &str[0]));
+}
 
 // ============================================================
 // Additional function implementations
@@ -486,18 +1014,15 @@ char integerToChar(int n) {
 
 string doubleToString(double d) { return realToString(d); }
 
-double stringToDouble(const string &str) { return stringToReal(str); }
+double stringToDouble(std::string_view str) { return stringToReal(str); }
 
-bool stringIsDouble(const string &str) { return stringIsReal(str); }
+bool stringIsDouble(std::string_view str) { return stringIsReal(str); }
 
-bool stringIsLong(const string &str, int radix) {
-  if (radix <= 0)
+bool stringIsLong(std::string_view str, int radix) {
+  if (radix < 2 || radix > 36)
     error("stringIsLong: Illegal radix");
-  istringstream stream(trim(str));
-  stream >> setbase(radix);
   long value;
-  stream >> value;
-  return !(stream.fail() || !stream.eof());
+  return _parseInteger(str, radix, value);
 }
 
 string pointerToString(void *p) {
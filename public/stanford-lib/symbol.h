@@ -0,0 +1,167 @@
+#pragma once
+#include "common.h"
+#include "flathash.h"
+#include <cstring>
+#include <string_view>
+
+// ============================================================
+// Symbol - interned, immutable string
+// ============================================================
+// Every distinct text is stored once, in a global intern table, and a
+// Symbol is just a pointer to its entry. Copying a Symbol copies one
+// pointer, == compares pointers, and the hash is computed once when the
+// text is first interned. < still compares the text, so Map<Symbol, ...>
+// and Set<Symbol> iterate in the same order as with string keys.
+//
+// Symbols compare directly against strings and string literals (no
+// interning needed), and convert implicitly to string, so they can be
+// used as Map / Set / HashMap keys wherever a string key was used:
+//   HashMap<Symbol, int> counts;
+//   for (const string &word : words)
+//     counts[word]++;
+// Interned text is never freed.
+
+class Symbol {
+private:
+  // Each entry's text is stored right after it in the same arena block
+  struct _Entry {
+    size_t hash;
+    size_t length;
+    std::string_view view() const {
+      return {reinterpret_cast<const char *>(this + 1), length};
+    }
+  };
+
+  class _Table {
+  private:
+    struct _KeyOf {
+      std::string_view operator()(const _Entry *e) const { return e->view(); }
+    };
+    static constexpr size_t kBlockSize = 16384;
+
+    FlatHashTable<const _Entry *, std::string_view, _KeyOf> _index;
+    vector<std::unique_ptr<char[]>> _blocks;
+    size_t _blockLeft = 0;
+    char *_next = nullptr;
+
+    // Bump-allocates entries from large blocks instead of one string each
+    _Entry *_allocate(size_t textLength) {
+      size_t align = alignof(_Entry);
+      size_t size = (sizeof(_Entry) + textLength + align - 1) / align * align;
+      if (size > _blockLeft) {
+        size_t blockSize = std::max(kBlockSize, size);
+        _blocks.emplace_back(new char[blockSize]);
+        _next = _blocks.back().get();
+        _blockLeft = blockSize;
+      }
+      _Entry *entry = reinterpret_cast<_Entry *>(_next);
+      _next += size;
+      _blockLeft -= size;
+      return entry;
+    }
+
+  public:
+    const _Entry *intern(std::string_view text) {
+      auto it = _index.find(text);
+      if (it != _index.end())
+        return *it;
+      _Entry *entry = new (_allocate(text.size()))
+          _Entry{std::hash<std::string_view>()(text), text.size()};
+      std::memcpy(entry + 1, text.data(), text.size());
+      _index.tryEmplace(entry->view(), entry);
+      return entry;
+    }
+    int size() const { return _index.size(); }
+  };
+
+  static _Table &_table() {
+    static _Table table;
+    return table;
+  }
+
+  // nullptr is the empty string
+  const _Entry *_e = nullptr;
+
+  template <typename S>
+  using _if_string_like =
+      std::enable_if_t<!std::is_same_v<S, Symbol> &&
+                       std::is_convertible_v<const S &, std::string_view>>;
+
+public:
+  Symbol() {}
+  Symbol(std::string_view text)
+      : _e(text.empty() ? nullptr : _table().intern(text)) {}
+  Symbol(const string &text) : Symbol(std::string_view(text)) {}
+  Symbol(const char *text) : Symbol(std::string_view(text)) {}
+
+  std::string_view view() const {
+    return _e ? _e->view() : std::string_view();
+  }
+  string str() const { return string(view()); }
+  operator string() const { return str(); }
+  // Lets a Symbol go straight to the strlib functions taking string_view
+  operator std::string_view() const { return view(); }
+
+  int length() const { return _e ? _e->length : 0; }
+  int size() const { return length(); }
+  bool empty() const { return _e == nullptr; }
+  char operator[](int i) const { return view()[i]; }
+  size_t hash() const { return _e ? _e->hash : 0; }
+  string toString() const { return str(); }
+
+  // Number of distinct texts interned so far
+  static int internedCount() { return _table().size(); }
+
+  friend bool operator==(const Symbol &a, const Symbol &b) {
+    return a._e == b._e;
+  }
+  friend bool operator!=(const Symbol &a, const Symbol &b) {
+    return a._e != b._e;
+  }
+  friend bool operator<(const Symbol &a, const Symbol &b) {
+    return a._e != b._e && a.view() < b.view();
+  }
+  friend bool operator<=(const Symbol &a, const Symbol &b) {
+    return !(b < a);
+  }
+  friend bool operator>(const Symbol &a, const Symbol &b) { return b < a; }
+  friend bool operator>=(const Symbol &a, const Symbol &b) {
+    return !(a < b);
+  }
+
+  // Comparisons against text never intern it
+  template <typename S, typename = _if_string_like<S>>
+  friend bool operator==(const Symbol &a, const S &b) {
+    return a.view() == std::string_view(b);
+  }
+  template <typename S, typename = _if_string_like<S>>
+  friend bool operator==(const S &a, const Symbol &b) {
+    return std::string_view(a) == b.view();
+  }
+  template <typename S, typename = _if_string_like<S>>
+  friend bool operator!=(const Symbol &a, const S &b) {
+    return !(a == b);
+  }
+  template <typename S, typename = _if_string_like<S>>
+  friend bool operator!=(const S &a, const Symbol &b) {
+    return !(a == b);
+  }
+  template <typename S, typename = _if_string_like<S>>
+  friend bool operator<(const Symbol &a, const S &b) {
+    return a.view() < std::string_view(b);
+  }
+  template <typename S, typename = _if_string_like<S>>
+  friend bool operator<(const S &a, const Symbol &b) {
+    return std::string_view(a) < b.view();
+  }
+};
+
+using InternedString = Symbol;
+
+ostream &operator<<(ostream &os, const Symbol &s) { return os << s.view(); }
+
+namespace std {
+template <> struct hash<Symbol> {
+  size_t operator()(const Symbol &s) const { return s.hash(); }
+};
+} // namespace std
@@ -1,133 +1,240 @@
 #pragma once
 #include "common.h"
 
-template <typename T> class Vector {
+template <typename T, typename Checks = DefaultChecks> class VectorView;
+
+template <typename T, typename Checks = DefaultChecks> class Vector {
 private:
-  vector<T> _v;
+  _Shareable<vector<T>> _v;
+  friend class VectorView<T, Checks>;
+
+  const vector<T> &_read() const { return _v.read(); }
+  vector<T> &_write() { return _v.write(); }
 
 public:
   Vector() {}
-  Vector(int n, T val) : _v(n, val) {}
-  Vector(std::initializer_list<T> list) : _v(list) {}
-
-  int size() const { return _v.size(); }
-  bool isEmpty() const { return _v.empty(); }
-  void clear() { _v.clear(); }
-
-  void add(const T &val) { _v.push_back(val); }
-  void push_back(const T &val) { _v.push_back(val); }
-  Vector<T> &addAll(const Vector<T> &v) {
-    for (const auto &val : v)
-      add(val);
+  Vector(int n, T val) { _write().assign(n, val); }
+  Vector(std::initializer_list<T> list) { _write().assign(list); }
+
+  int size() const { return _read().size(); }
+  bool isEmpty() const { return _read().empty(); }
+  void clear() { _v.reset(); }
+
+  void reserve(int n) {
+    if (Checks::check && n < 0)
+      error("Vector::reserve: negative capacity");
+    _write().reserve(n);
+  }
+  int capacity() const { return _read().capacity(); }
+  void shrinkToFit() { _write().shrink_to_fit(); }
+
+  void add(const T &val) { _write().push_back(val); }
+  void add(T &&val) { _write().push_back(std::move(val)); }
+  void push_back(const T &val) { _write().push_back(val); }
+  void push_back(T &&val) { _write().push_back(std::move(val)); }
+  template <typename... Args> T &emplace_back(Args &&...args) {
+    vector<T> &elems = _write();
+    elems.emplace_back(std::forward<Args>(args)...);
+    return elems.back();
+  }
+  Vector &addAll(const Vector &v) {
+    vector<T> &elems = _write();
+    if (this == &v) {
+      size_t n = elems.size();
+      elems.reserve(2 * n);
+      for (size_t i = 0; i < n; i++)
+        elems.push_back(elems[i]);
+      return *this;
+    }
+    elems.insert(elems.end(), v._read().begin(), v._read().end());
+    return *this;
+  }
+  Vector &addAll(Vector &&v) {
+    // Elements of a buffer other copies still share cannot be moved from
+    if (this == &v || v._v.owners() > 1) {
+      addAll(static_cast<const Vector &>(v));
+      if (this != &v)
+        v.clear();
+      return *this;
+    }
+    if (isEmpty()) {
+      _v = std::move(v._v);
+    } else {
+      vector<T> &elems = _write();
+      vector<T> &other = v._write();
+      elems.insert(elems.end(), std::make_move_iterator(other.begin()),
+                   std::make_move_iterator(other.end()));
+    }
+    v.clear();
     return *this;
   }
   void insert(int i, const T &val) {
-    if (i < 0 || i > (int)_v.size())
+    if (Checks::check && (i < 0 || i > size()))
+      error("Vector::insert: index out of range");
+    vector<T> &elems = _write();
+    elems.insert(elems.begin() + i, val);
+  }
+  void insert(int i, T &&val) {
+    if (Checks::check && (i < 0 || i > size()))
       error("Vector::insert: index out of range");
-    _v.insert(_v.begin() + i, val);
+    vector<T> &elems = _write();
+    elems.insert(elems.begin() + i, std::move(val));
+  }
+  template <typename... Args> T &emplace(int i, Args &&...args) {
+    if (Checks::check && (i < 0 || i > size()))
+      error("Vector::emplace: index out of range");
+    vector<T> &elems = _write();
+    return *elems.emplace(elems.begin() + i, std::forward<Args>(args)...);
   }
   T remove(int i) {
-    if (i < 0 || i >= (int)_v.size())
+    if (Checks::check && (i < 0 || i >= size()))
       error("Vector::remove: index out of range");
-    T val = _v[i];
-    _v.erase(_v.begin() + i);
+    vector<T> &elems = _write();
+    T val = std::move(elems[i]);
+    elems.erase(elems.begin() + i);
     return val;
   }
 
   const T &get(int i) const {
-    if (i < 0 || i >= (int)_v.size())
+    if (Checks::check && (i < 0 || i >= size()))
       error("Vector::get: index out of range");
-    return _v.at(i);
+    return _checked_at<Checks>(_read(), i);
   }
   void set(int i, const T &val) {
-    if (i < 0 || i >= (int)_v.size())
+    if (Checks::check && (i < 0 || i >= size()))
+      error("Vector::set: index out of range");
+    _checked_at<Checks>(_write(), i) = val;
+  }
+  void set(int i, T &&val) {
+    if (Checks::check && (i < 0 || i >= size()))
       error("Vector::set: index out of range");
-    _v.at(i) = val;
+    _checked_at<Checks>(_write(), i) = std::move(val);
   }
 
-  bool equals(const Vector<T> &v) const { return _v == v._v; }
+  bool equals(const Vector &v) const { return *this == v; }
 
-  void mapAll(std::function<void(const T &)> fn) const {
-    for (const auto &elem : _v)
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (const auto &elem : _read())
       fn(elem);
   }
 
-  void sort() { std::sort(_v.begin(), _v.end()); }
+  void sort() {
+    vector<T> &elems = _write();
+    std::sort(elems.begin(), elems.end());
+  }
 
-  Vector<T> subList(int start, int length) const {
-    if (start < 0 || start > (int)_v.size() || start + length < 0 ||
-        start + length > (int)_v.size() || length < 0)
+  Vector subList(int start, int length) const {
+    if (Checks::check &&
+        (start < 0 || start > size() || start + length < 0 ||
+         start + length > size() || length < 0))
       error("Vector::subList: invalid range");
-    Vector<T> result;
-    for (int i = start; i < start + length; i++)
-      result.add(_v[i]);
+    if (start == 0 && length == size())
+      return *this; // shares the buffer in COW mode
+    Vector result;
+    result._write().assign(_read().begin() + start,
+                           _read().begin() + start + length);
     return result;
   }
 
-  Vector<T> subList(int start) const {
-    return subList(start, _v.size() - start);
-  }
+  Vector subList(int start) const { return subList(start, size() - start); }
+
+  // Zero-copy counterparts of subList; see VectorView below
+  VectorView<T, Checks> slice(int start, int length) const;
+  VectorView<T, Checks> slice(int start) const;
 
   T &operator[](int i) {
-    if (i < 0 || i >= (int)_v.size())
+    if (Checks::check && (i < 0 || i >= size()))
       error("Vector::operator[]: index out of range");
-    return _v[i];
+    return _write()[i];
   }
   const T &operator[](int i) const {
-    if (i < 0 || i >= (int)_v.size())
+    if (Checks::check && (i < 0 || i >= size()))
       error("Vector::operator[]: index out of range");
-    return _v[i];
+    return _read()[i];
   }
 
-  Vector<T> operator+(const Vector<T> &v2) const {
-    Vector<T> result = *this;
+  Vector operator+(const Vector &v2) const & {
+    Vector result;
+    vector<T> &elems = result._write();
+    elems.reserve(size() + v2.size());
+    elems.assign(_read().begin(), _read().end());
     return result.addAll(v2);
   }
+  // A temporary left operand (as in a + b + c) is reused instead of copied
+  Vector operator+(const Vector &v2) && {
+    addAll(v2);
+    return std::move(*this);
+  }
+  Vector operator+(Vector &&v2) && {
+    addAll(std::move(v2));
+    return std::move(*this);
+  }
 
-  Vector<T> operator+(const T &elem) const {
-    Vector<T> result = *this;
+  Vector operator+(const T &elem) const & {
+    Vector result = *this;
     result.add(elem);
     return result;
   }
+  Vector operator+(const T &elem) && {
+    add(elem);
+    return std::move(*this);
+  }
+  Vector operator+(T &&elem) && {
+    add(std::move(elem));
+    return std::move(*this);
+  }
 
-  Vector<T> &operator+=(const Vector<T> &v2) { return addAll(v2); }
-  Vector<T> &operator+=(const T &val) {
+  Vector &operator+=(const Vector &v2) { return addAll(v2); }
+  Vector &operator+=(Vector &&v2) { return addAll(std::move(v2)); }
+  Vector &operator+=(const T &val) {
     add(val);
     return *this;
   }
+  Vector &operator+=(T &&val) {
+    add(std::move(val));
+    return *this;
+  }
 
-  Vector<T> &operator,(const T &value) {
+  Vector &operator,(const T &value) {
     add(value);
     return *this;
   }
+  Vector &operator,(T &&value) {
+    add(std::move(value));
+    return *this;
+  }
 
   string toString() const {
+    const vector<T> &elems = _read();
     stringstream ss;
     ss << "{";
-    for (size_t i = 0; i < _v.size(); i++)
-      ss << _v[i] << (i < _v.size() - 1 ? ", " : "");
+    for (size_t i = 0; i < elems.size(); i++)
+      ss << elems[i] << (i < elems.size() - 1 ? ", " : "");
     ss << "}";
     return ss.str();
   }
   string toDebugString() const {
+    const vector<T> &elems = _read();
     stringstream ss;
     ss << "[";
-    for (size_t i = 0; i < _v.size(); i++)
-      ss << _json_val(_v[i]) << (i < _v.size() - 1 ? ", " : "");
+    for (size_t i = 0; i < elems.size(); i++)
+      ss << _json_val(elems[i]) << (i < elems.size() - 1 ? ", " : "");
     ss << "]";
-    return ss.str();
+    return _debug_shared(_v, ss.str());
   }
 
-  typename vector<T>::iterator begin() { return _v.begin(); }
-  typename vector<T>::iterator end() { return _v.end(); }
-  typename vector<T>::const_iterator begin() const { return _v.begin(); }
-  typename vector<T>::const_iterator end() const { return _v.end(); }
+  typename vector<T>::iterator begin() { return _write().begin(); }
+  typename vector<T>::iterator end() { return _write().end(); }
+  typename vector<T>::const_iterator begin() const { return _read().begin(); }
+  typename vector<T>::const_iterator end() const { return _read().end(); }
 
-  bool operator==(const Vector<T> &other) const { return _v == other._v; }
-  bool operator!=(const Vector<T> &other) const { return _v != other._v; }
-  bool operator<(const Vector<T> &v2) const {
-    auto it1 = _v.begin(), it2 = v2._v.begin();
-    auto end1 = _v.end(), end2 = v2._v.end();
+  bool operator==(const Vector &other) const {
+    return _v.buffer() == other._v.buffer() || _read() == other._read();
+  }
+  bool operator!=(const Vector &other) const { return !(*this == other); }
+  bool operator<(const Vector &v2) const {
+    auto it1 = begin(), it2 = v2.begin();
+    auto end1 = end(), end2 = v2.end();
     while (it1 != end1 && it2 != end2) {
       if (*it1 < *it2)
         return true;
@@ -138,14 +245,141 @@ public:
     }
     return it1 == end1 && it2 != end2;
   }
-  bool operator<=(const Vector<T> &v2) const {
+  bool operator<=(const Vector &v2) const {
     return *this < v2 || *this == v2;
   }
-  bool operator>(const Vector<T> &v2) const { return v2 < *this; }
-  bool operator>=(const Vector<T> &v2) const { return v2 <= *this; }
+  bool operator>(const Vector &v2) const { return v2 < *this; }
+  bool operator>=(const Vector &v2) const { return v2 <= *this; }
+};
+
+template <typename T, typename Checks>
+ostream &operator<<(ostream &os, const Vector<T, Checks> &v) {
+  os << v.toString();
+  return os;
+}
+
+namespace std {
+template <typename T, typename Checks> struct hash<Vector<T, Checks>> {
+  size_t operator()(const Vector<T, Checks> &v) const {
+    return _hashRange(v.begin(), v.end());
+  }
+};
+} // namespace std
+
+// ============================================================
+// VectorView - non-owning, read-only window into a Vector
+// ============================================================
+// Slicing a view is O(1), so recursive divide-and-conquer code
+// (binary search, merge sort) can pass v.slice(0, mid) around
+// without copying. The parent Vector must outlive the view and must
+// not be resized while the view is in use.
+
+template <typename T, typename Checks> class VectorView {
+private:
+  const Vector<T, Checks> *_parent;
+  const T *_data;
+  int _offset, _size;
+
+  VectorView(const Vector<T, Checks> *parent, int offset, int length)
+      : _parent(parent), _data(parent->_read().data() + offset),
+        _offset(offset), _size(length) {}
+
+public:
+  VectorView() : _parent(nullptr), _data(nullptr), _offset(0), _size(0) {}
+  VectorView(const Vector<T, Checks> &v) : VectorView(&v, 0, v.size()) {}
+
+  int size() const { return _size; }
+  bool isEmpty() const { return _size == 0; }
+
+  const T &get(int i) const {
+    if (Checks::check && (i < 0 || i >= _size))
+      error("VectorView::get: index out of range");
+    return _data[i];
+  }
+  const T &operator[](int i) const {
+    if (Checks::check && (i < 0 || i >= _size))
+      error("VectorView::operator[]: index out of range");
+    return _data[i];
+  }
+
+  VectorView subList(int start, int length) const {
+    if (Checks::check &&
+        (start < 0 || start > _size || length < 0 || start + length > _size))
+      error("VectorView::subList: invalid range");
+    return VectorView(_parent, _offset + start, length);
+  }
+  VectorView subList(int start) const {
+    return subList(start, _size - start);
+  }
+
+  template <typename Fn> void mapAll(Fn fn) const {
+    for (const auto &elem : *this)
+      fn(elem);
+  }
+
+  // Materializes the window as an owning Vector (copies the elements)
+  operator Vector<T, Checks>() const {
+    Vector<T, Checks> result;
+    result.reserve(_size);
+    for (const auto &elem : *this)
+      result.add(elem);
+    return result;
+  }
+
+  string toString() const {
+    stringstream ss;
+    ss << "{";
+    for (int i = 0; i < _size; i++)
+      ss << _data[i] << (i < _size - 1 ? ", " : "");
+    ss << "}";
+    return ss.str();
+  }
+  string toDebugString() const {
+    stringstream ss;
+    ss << "{\"__type\": \"VectorView\", \"parent\": \""
+       << (const void *)_parent << "\", \"offset\": " << _offset
+       << ", \"length\": " << _size << ", \"data\": [";
+    for (int i = 0; i < _size; i++)
+      ss << _json_val(_data[i]) << (i < _size - 1 ? ", " : "");
+    ss << "]}";
+    return ss.str();
+  }
+
+  const T *begin() const { return _data; }
+  const T *end() const { return _data + _size; }
+
+  friend bool operator==(const VectorView &a, const VectorView &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+  friend bool operator==(const VectorView &a, const Vector<T, Checks> &b) {
+    return a == VectorView(b);
+  }
+  friend bool operator==(const Vector<T, Checks> &a, const VectorView &b) {
+    return VectorView(a) == b;
+  }
+  friend bool operator!=(const VectorView &a, const VectorView &b) {
+    return !(a == b);
+  }
+  friend bool operator!=(const VectorView &a, const Vector<T, Checks> &b) {
+    return !(a == b);
+  }
+  friend bool operator!=(const Vector<T, Checks> &a, const VectorView &b) {
+    return !(a == b);
+  }
 };
 
-template <typename T> ostream &operator<<(ostream &os, const Vector<T> &v) {
+template <typename T, typename Checks>
+VectorView<T, Checks> Vector<T, Checks>::slice(int start, int length) const {
+  return VectorView<T, Checks>(*this).subList(start, length);
+}
+
+template <typename T, typename Checks>
+VectorView<T, Checks> Vector<T, Checks>::slice(int start) const {
+  return slice(start, size() - start);
+}
+
+template <typename T, typename Checks>
+ostream &operator<<(ostream &os, const VectorView<T, Checks> &v) {
   os << v.toString();
   return os;
 }
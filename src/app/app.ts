@@ -5,11 +5,12 @@ import { FormsModule } from '@angular/forms';
 import { RouterOutlet } from '@angular/router';
 import { Subject, of, from, Subscription } from 'rxjs';
 import { switchMap, tap, map, catchError, takeUntil, debounceTime } from 'rxjs/operators';
-import { LucideAngularModule, Play, Square, StepForward, StepBack, Bug, FileCode, Terminal, CheckCircle, XCircle, FastForward, Pause, Sun, Moon, Loader2, ArrowRight, CornerDownRight, LogIn } from 'lucide-angular';
+import { LucideAngularModule, Play, Square, StepForward, StepBack, Bug, FileCode, Terminal, CheckCircle, XCircle, FastForward, Pause, Sun, Moon, Loader2, ArrowRight, CornerDownRight, LogIn, Zap, Paperclip } from 'lucide-angular';
 
 import { CompanionFile } from './companion-files';
 import { FilesService, FilesLoadingStatus } from './services/files.service';
 import { instrumentCode, initTreeSitter, isTreeSitterReady } from './debugger-utils';
+import { OutputRing } from './output-ring';
 import { MonacoEditorComponent } from './components/monaco-editor/monaco-editor.component';
 import { VariableVizComponent } from './components/variable-viz/variable-viz.component';
 import { SashComponent } from './components/sash/sash.component';
@@ -76,8 +77,12 @@ export class App implements AfterViewInit, OnDestroy {
   }
 
   // Processed output for display - strips ANSI codes and adds error highlighting
+  // Cached per log string, since change detection reads this every cycle
+  private processedFor: string | null = null;
+  private processedHtml = '';
   get processedOutputHtml(): string {
     const raw = this.outputLogs;
+    if (raw === this.processedFor) return this.processedHtml;
     // Strip ANSI escape codes
     const stripped = raw.replace(/\x1b\[[0-9;]*m/g, '').replace(/\[\d+(?:;\d+)*m/g, '');
 
@@ -95,7 +100,9 @@ export class App implements AfterViewInit, OnDestroy {
       }
       return escaped;
     });
-    return processed.join('\n');
+    this.processedFor = raw;
+    this.processedHtml = processed.join('\n');
+    return this.processedHtml;
   }
 
   get debugVars() {
@@ -125,12 +132,20 @@ export class App implements AfterViewInit, OnDestroy {
   worker: Worker | null = null;
   testResults: { pass: boolean; expression: string; expected?: string; actual?: string }[] = [];
   activeTab: 'console' | 'tests' | 'variables' = 'console';
+  // Files attached by the user; written into the worker's memfs before each run
+  inputFiles: { name: string; data: Uint8Array }[] = [];
 
   // Theme State
   isDark = true;
   isLoading = false;
 
   sharedBuffer: Int32Array | null = null;
+  // Program output arrives through this ring, drained once per frame
+  private outputRing: OutputRing | null = null;
+  private outputPumpGeneration = 0;
+  // The console keeps the most recent output once it grows past the limit
+  readonly MAX_CONSOLE_CHARS = 400_000;
+  readonly CONSOLE_KEEP_CHARS = 300_000;
 
   // Debugging state
   breakpoints: Set<number> = new Set();
@@ -146,7 +161,7 @@ export class App implements AfterViewInit, OnDestroy {
 
   // Icon imports for template
   readonly icons = {
-    Play, Square, StepForward, StepBack, Bug, FileCode, Terminal, CheckCircle, XCircle, FastForward, Pause, Sun, Moon, Loader2, ArrowRight, CornerDownRight, LogIn
+    Play, Square, StepForward, StepBack, Bug, FileCode, Terminal, CheckCircle, XCircle, FastForward, Pause, Sun, Moon, Loader2, ArrowRight, CornerDownRight, LogIn, Zap, Paperclip
   };
 
   constructor(
@@ -477,7 +492,34 @@ export class App implements AfterViewInit, OnDestroy {
     }
   }
 
-  async startDebugger() {
+  async attachInputFiles(event: Event) {
+    const input = event.target as HTMLInputElement;
+    for (const file of Array.from(input.files ?? [])) {
+      const data = new Uint8Array(await file.arrayBuffer());
+      // Re-attaching a file replaces the earlier copy
+      this.inputFiles = [...this.inputFiles.filter(f => f.name !== file.name), { name: file.name, data }];
+    }
+    input.value = '';
+    this.cdr.detectChanges();
+  }
+
+  clearInputFiles() {
+    this.inputFiles = [];
+  }
+
+  inputFileNames(): string {
+    return this.inputFiles.map(f => `${f.name} (${f.data.length} bytes)`).join(', ');
+  }
+
+  /**
+   * Compile without instrumentation or library range checks and run straight
+   * through, for timing code rather than stepping through it.
+   */
+  runFast() {
+    this.startDebugger('fast');
+  }
+
+  async startDebugger(mode: 'debug' | 'fast' = 'debug') {
     this._liveOutputLogs = "[STARTING WORKER...]\n";
     this.isDebugging = true;
     this.isCompiling = true;
@@ -487,7 +529,7 @@ export class App implements AfterViewInit, OnDestroy {
     if (this.editor) this.editor.setExecutionLine(null);
 
     // Initialize Tree-sitter if not already done
-    if (!isTreeSitterReady()) {
+    if (mode === 'debug' && !isTreeSitterReady()) {
       this._liveOutputLogs += "[Initializing C++ Debugger...]\n";
       try {
         await initTreeSitter();
@@ -514,8 +556,11 @@ export class App implements AfterViewInit, OnDestroy {
         return;
       }
       this.sharedBuffer = new Int32Array(new SharedArrayBuffer(4));
-      this.sharedBuffer[0] = 0; // 0 = PAUSED, 1 = STEP, 2 = RUN
+      this.sharedBuffer[0] = mode === 'fast' ? 2 : 0; // 0 = PAUSED, 1 = STEP, 2 = RUN
       this.worker.postMessage({ command: 'configure-debug', buffer: this.sharedBuffer.buffer });
+      this.outputRing = OutputRing.create();
+      this.worker.postMessage({ command: 'configure-output', buffer: this.outputRing.buffer });
+      this.startOutputPump();
 
       // Send breakpoints
       // IMPORTANT: The worker might process this before or after compile? 
@@ -526,6 +571,10 @@ export class App implements AfterViewInit, OnDestroy {
       });
 
       this.worker.onmessage = ({ data }) => {
+        // Output written before this message was posted must come first:
+        // debug-paused snapshots the variables it carries, and finished
+        // ends the run
+        this.flushOutput();
         if (data.type === 'log') {
           this.ngZone.run(() => {
             this.processWorkerOutput(data.text);
@@ -538,6 +587,7 @@ export class App implements AfterViewInit, OnDestroy {
             this.cdr.detectChanges();
           });
         } else if (data.type === 'finished') {
+          this.stopOutputPump();
           this.ngZone.run(() => {
             this._liveOutputLogs += "\n[FINISHED]";
             // Keep isDebugging true so UI stays in debug mode
@@ -585,9 +635,9 @@ export class App implements AfterViewInit, OnDestroy {
         }
       };
 
-      // Instrument code
-      const codeToRun = instrumentCode(this.studentCode);
-      this.worker.postMessage({ command: 'compile', code: codeToRun });
+      // Instrument code (fast runs compile the student's code as-is)
+      const codeToRun = mode === 'debug' ? instrumentCode(this.studentCode) : this.studentCode;
+      this.worker.postMessage({ command: 'compile', code: codeToRun, mode, files: this.inputFiles });
 
     } else {
       this._liveOutputLogs += "[ERROR] Web Workers not supported in this environment.";
@@ -634,6 +684,8 @@ export class App implements AfterViewInit, OnDestroy {
   }
 
   stop() {
+    this.stopOutputPump();
+    this.outputRing = null;
     if (this.worker) {
       this.worker.terminate();
       this.worker = null;
@@ -716,13 +768,43 @@ export class App implements AfterViewInit, OnDestroy {
   private capturedVarsLines: string[] = [];
   private capturedStackLines: string[] = [];
 
+  /** Drains program output once per animation frame while a program runs. */
+  private startOutputPump() {
+    const generation = ++this.outputPumpGeneration;
+    this.ngZone.runOutsideAngular(() => {
+      const tick = () => {
+        if (generation !== this.outputPumpGeneration) return;
+        this.flushOutput();
+        // Frames stop in background tabs; keep draining so the program
+        // is not left blocked on a full ring
+        if (document.hidden) setTimeout(tick, 100);
+        else requestAnimationFrame(tick);
+      };
+      requestAnimationFrame(tick);
+    });
+  }
+
+  private stopOutputPump() {
+    this.outputPumpGeneration++;
+  }
+
+  private flushOutput() {
+    const text = this.outputRing?.drain();
+    if (!text) return;
+    this.ngZone.run(() => {
+      this.processWorkerOutput(text);
+      this.cdr.detectChanges();
+    });
+  }
+
   private processWorkerOutput(chunk: string) {
     this.logBuffer += chunk;
 
+    let start = 0;
     let newlineIdx: number;
-    while ((newlineIdx = this.logBuffer.indexOf('\n')) !== -1) {
-      const line = this.logBuffer.slice(0, newlineIdx + 1); // keep newline for raw output if needed
-      this.logBuffer = this.logBuffer.slice(newlineIdx + 1);
+    while ((newlineIdx = this.logBuffer.indexOf('\n', start)) !== -1) {
+      const line = this.logBuffer.slice(start, newlineIdx + 1); // keep newline for raw output if needed
+      start = newlineIdx + 1;
 
       const trimmed = line.trim();
 
@@ -762,6 +844,14 @@ export class App implements AfterViewInit, OnDestroy {
         this.parseTestResult(line);
       }
     }
+    this.logBuffer = this.logBuffer.slice(start);
+
+    if (this._liveOutputLogs.length > this.MAX_CONSOLE_CHARS) {
+      // Cut at a line boundary; the notice replaces any earlier one
+      const from = this._liveOutputLogs.length - this.CONSOLE_KEEP_CHARS;
+      const cut = this._liveOutputLogs.indexOf('\n', from) + 1 || from;
+      this._liveOutputLogs = '[... earlier output truncated ...]\n' + this._liveOutputLogs.slice(cut);
+    }
   }
 
   private updateDebugVars() {
@@ -1,14 +1,17 @@
 /// <reference lib="webworker" />
+import { OutputRing } from './output-ring';
 
 // Stanford library headers to load at runtime (instead of bundled constant)
 const STANFORD_HEADERS = [
   'debug_core.h', 'common.h', 'strlib.h', 'vector.h', 'grid.h',
-  'set.h', 'map.h', 'stack.h', 'queue.h',
-  'hashmap.h', 'hashset.h', 'priorityqueue.h',  // New collections
+  'flatstorage.h', 'set.h', 'map.h', 'stack.h', 'queue.h', 'flathash.h',
+  'hashmap.h', 'hashset.h', 'priorityqueue.h', 'symbol.h',  // New collections
+  'lexicon.h', 'graph.h', 'sparsegrid.h', 'smallintset.h', 'filelib.h',
+  'ranges.h', 'combinatorics.h',
   'stanford.h'
 ];
 
-const HEADER_CACHE_NAME = 'stanford-headers-v2';  // Bumped to re-fetch with new headers
+const HEADER_CACHE_NAME = 'stanford-headers-v25';  // Bumped to re-fetch with new headers
 
 async function loadHeaders(): Promise<{ name: string; content: string }[]> {
   const cache = await caches.open(HEADER_CACHE_NAME);
@@ -41,6 +44,8 @@ async function loadHeaders(): Promise<{ name: string; content: string }[]> {
 // Lazy load wasm-clang to reduce initial bundle size
 let API: any = null;
 let api: any = null;
+// Set by 'configure-output'; without it output falls back to 'log' messages
+let outputRing: OutputRing | null = null;
 
 async function bootstrap() {
   if (api) return;
@@ -56,7 +61,8 @@ async function bootstrap() {
 
   api = new API({
     hostWrite: (s: string) => {
-      postMessage({ type: 'log', text: s });
+      if (outputRing) outputRing.write(s);
+      else postMessage({ type: 'log', text: s });
     },
     cdnUrl: '/wasm/',
     memfs: 'memfs.wasm',
@@ -137,6 +143,8 @@ WebAssembly.instantiate = (moduleObject: WebAssembly.Module | BufferSource, impo
 addEventListener('message', async ({ data }) => {
   if (data.command === 'configure-debug') {
     sharedBuffer = new Int32Array(data.buffer);
+  } else if (data.command === 'configure-output') {
+    outputRing = new OutputRing(data.buffer);
   } else if (data.command === 'update-breakpoints') {
     breakpoints = new Set(data.breakpoints);
   } else if (data.command === 'write-file') {
@@ -157,6 +165,12 @@ addEventListener('message', async ({ data }) => {
     try {
       await bootstrap();
 
+      // Input files attached in the editor, readable through filelib.h
+      for (const { name, data: content } of data.files ?? []) {
+        api.memfs.addFile(name, content);
+        postMessage({ type: 'log', text: `[FS] Attached ${name} (${content.length} bytes)\n` });
+      }
+
       postMessage({ type: 'log', text: '[Worker] Compiling...\n' });
 
       const input = `test.cc`;
@@ -164,12 +178,18 @@ addEventListener('message', async ({ data }) => {
       const wasm = `test.wasm`;
       const source = `#include "debug_core.h"\n${data.code}`; // Always prepend debug macros
 
+      // Debug runs keep the Stanford library's friendly range checks; "fast"
+      // runs (uninstrumented, for timing) compile them out entirely.
+      const modeFlags = data.mode === 'fast'
+        ? ['-O2', '-DSTANFORD_CHECKS=NoChecks']
+        : [];
+
       // 1. Compile (Source -> Object)
       await api.compile({
         input,
         contents: source,
         obj,
-        clangFlags: ['-std=c++17', '-Wno-deprecated-declarations']
+        clangFlags: ['-std=c++17', '-Wno-deprecated-declarations', ...modeFlags]
       });
 
       // 2. Link (Object -> WASM)
@@ -233,6 +233,16 @@ export class VariableVizComponent implements OnChanges, AfterViewChecked {
         // Type detection and routing to specialized renderers
         if (this.isGridType(parsed)) {
           return this.sanitizer.bypassSecurityTrustHtml(this.renderGrid(objAddr, parsed));
+        } else if (this.isVectorViewType(parsed)) {
+          return this.sanitizer.bypassSecurityTrustHtml(this.renderVectorView(objAddr, parsed));
+        } else if (this.isQueueType(parsed)) {
+          return this.sanitizer.bypassSecurityTrustHtml(this.renderQueue(objAddr, parsed));
+        } else if (this.isSharedType(parsed)) {
+          return this.sanitizer.bypassSecurityTrustHtml(this.renderShared(objAddr, parsed));
+        } else if (this.isGraphType(parsed)) {
+          return this.sanitizer.bypassSecurityTrustHtml(this.renderGraph(objAddr, parsed));
+        } else if (this.isSparseGridType(parsed)) {
+          return this.sanitizer.bypassSecurityTrustHtml(this.renderSparseGrid(objAddr, parsed));
         } else if (Array.isArray(parsed)) {
           return this.sanitizer.bypassSecurityTrustHtml(this.renderArray(objAddr, parsed));
         } else {
@@ -289,6 +299,187 @@ export class VariableVizComponent implements OnChanges, AfterViewChecked {
     return html;
   }
 
+  /**
+   * Type detection: Check if the parsed object is a SparseGrid
+   */
+  private isSparseGridType(parsed: any): boolean {
+    return parsed && typeof parsed === 'object' && parsed.__type === 'SparseGrid';
+  }
+
+  /**
+   * Render a SparseGrid as the window of the board around its live cells,
+   * with the board's own row/column indices. Background cells are blank.
+   * When the live cells are spread too far apart for a table, list them.
+   */
+  private renderSparseGrid(
+    objAddr: string,
+    grid: { rows: number; cols: number; tiles: number; live: number; background: any; cells: [number, number, any][] }
+  ): string {
+    const { rows, cols, tiles, live, cells } = grid;
+    let html = `<div class="text-[10px] text-muted-foreground mb-1">${rows} x ${cols} board, ${live} live cells in ${tiles} tiles</div>`;
+    if (cells.length === 0) return html;
+
+    const minRow = Math.min(...cells.map(([r]) => r)), maxRow = Math.max(...cells.map(([r]) => r));
+    const minCol = Math.min(...cells.map(([, c]) => c)), maxCol = Math.max(...cells.map(([, c]) => c));
+    if (maxRow - minRow >= 24 || maxCol - minCol >= 24) {
+      return html + this.renderArray(objAddr, cells.map(([r, c, v]) => `r${r}c${c}: ${v}`));
+    }
+    const byLoc = new Map<string, any>(cells.map(([r, c, v]) => [`${r},${c}`, v] as [string, any]));
+    html += `<table class="w-full text-xs border-collapse font-mono">`;
+    html += `<tr class="bg-muted/30"><th class="w-8 h-7 border border-border bg-muted/50"></th>`;
+    for (let c = minCol; c <= maxCol; c++) {
+      html += `<th class="w-10 h-7 text-center text-muted-foreground font-bold border border-border bg-muted/50">${c}</th>`;
+    }
+    html += `</tr>`;
+    for (let r = minRow; r <= maxRow; r++) {
+      html += `<tr><td class="w-8 h-7 text-center text-muted-foreground font-bold border border-border bg-muted/50">${r}</td>`;
+      for (let c = minCol; c <= maxCol; c++) {
+        const value = byLoc.get(`${r},${c}`);
+        const displayVal = value !== undefined ? this.processValueString(objAddr, String(value)) : '';
+        html += `<td class="w-10 h-7 text-center text-foreground border border-border px-1">${displayVal}</td>`;
+      }
+      html += `</tr>`;
+    }
+    html += `</table>`;
+    return html;
+  }
+
+  /**
+   * Type detection: Check if the parsed object is a VectorView (slice of a Vector)
+   */
+  private isVectorViewType(parsed: any): boolean {
+    return parsed && typeof parsed === 'object' && parsed.__type === 'VectorView';
+  }
+
+  /**
+   * Render a VectorView as a window into its parent: rows are labeled with
+   * the parent's indices, under a header naming the parent and the range.
+   */
+  private renderVectorView(
+    objAddr: string,
+    view: { parent: string; offset: number; length: number; data: any[] }
+  ): string {
+    const { parent, offset, length, data } = view;
+    let html = `<div class="text-[10px] text-muted-foreground mb-1">view of ${this.processValueString(objAddr, parent)} [${offset}, ${offset + length})</div>`;
+    html += `<table class="w-full text-xs border-collapse border-l-2 border-primary/50">`;
+    data.forEach((item, i) => {
+      const displayVal = this.processValueString(objAddr, String(item));
+      html += `
+        <tr class="border-b border-border last:border-0">
+          <td class="py-1 pr-2 font-bold text-muted-foreground w-8 align-top text-right">${offset + i}</td>
+          <td class="py-1 font-mono text-foreground break-all pl-2 border-l border-border/50">${displayVal}</td>
+        </tr>
+      `;
+    });
+    html += `</table>`;
+    return html;
+  }
+
+  /**
+   * Type detection: Check if the parsed object is a Queue (ring buffer)
+   */
+  private isQueueType(parsed: any): boolean {
+    return parsed && typeof parsed === 'object' && parsed.__type === 'Queue';
+  }
+
+  /**
+   * Render a Queue front to back, labeling each element with the ring slot
+   * it occupies, under a header showing the head/tail slots and capacity.
+   */
+  private renderQueue(
+    objAddr: string,
+    queue: { capacity: number; head: number; tail: number; data: any[] }
+  ): string {
+    const { capacity, head, tail, data } = queue;
+    let html = `<div class="text-[10px] text-muted-foreground mb-1">ring head ${head}, tail ${tail}, capacity ${capacity}</div>`;
+    html += `<table class="w-full text-xs border-collapse">`;
+    data.forEach((item, i) => {
+      const slot = capacity ? (head + i) % capacity : i;
+      const marker = i === 0 ? 'front' : i === data.length - 1 ? 'back' : '';
+      const displayVal = this.processValueString(objAddr, String(item));
+      html += `
+        <tr class="border-b border-border last:border-0">
+          <td class="py-1 pr-2 font-bold text-muted-foreground w-8 align-top text-right">${slot}</td>
+          <td class="py-1 font-mono text-foreground break-all pl-2 border-l border-border/50">${displayVal}</td>
+          <td class="py-1 pl-2 text-[10px] text-muted-foreground w-10 align-top">${marker}</td>
+        </tr>
+      `;
+    });
+    html += `</table>`;
+    return html;
+  }
+
+  /**
+   * Type detection: Check if the parsed object is a copy-on-write container
+   * whose buffer is shared with other copies (STANFORD_COW)
+   */
+  private isSharedType(parsed: any): boolean {
+    return parsed && typeof parsed === 'object' && parsed.__type === 'Shared';
+  }
+
+  /**
+   * Render a shared container as a link to its buffer: the contents are
+   * shown once, on the buffer's heap object, with an arrow from each owner.
+   */
+  private renderShared(objAddr: string, shared: { buffer: string; owners: number }): string {
+    const { buffer, owners } = shared;
+    return `<div class="text-xs text-muted-foreground">shared with ${owners - 1} other ${owners === 2 ? 'copy' : 'copies'}: ${this.processValueString(objAddr, buffer)}</div>`;
+  }
+
+  /**
+   * Type detection: Check if the parsed object is a Graph or GraphBuilder
+   */
+  private isGraphType(parsed: any): boolean {
+    return parsed && typeof parsed === 'object' && parsed.__type === 'Graph';
+  }
+
+  /**
+   * Render a Graph as a node-link diagram, with the vertices on a circle in
+   * id order. Weights are labeled unless every edge weighs 1. Large graphs
+   * arrive truncated to their first vertices; the header says so.
+   */
+  private renderGraph(
+    objAddr: string,
+    graph: { directed: boolean; numVertices: number; numEdges: number; vertices: any[]; edges: [number, number, any][] }
+  ): string {
+    const { directed, numVertices, numEdges, vertices, edges } = graph;
+    const size = 240, radius = 14, center = size / 2;
+    const ring = vertices.length > 1 ? center - radius - 4 : 0;
+    const pos = vertices.map((_, i) => {
+      const angle = (2 * Math.PI * i) / vertices.length - Math.PI / 2;
+      return { x: center + ring * Math.cos(angle), y: center + ring * Math.sin(angle) };
+    });
+    const weighted = edges.some(([, , w]) => Number(w) !== 1);
+    const escapeText = (text: any) => String(text).replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');
+
+    let html = `<div class="text-[10px] text-muted-foreground mb-1">${directed ? 'directed' : 'undirected'}, ${numVertices} vertices, ${numEdges} edges`;
+    if (vertices.length < numVertices) html += ` (showing ${vertices.length})`;
+    html += `</div>`;
+    html += `<svg viewBox="0 0 ${size} ${size}" class="w-full max-w-[240px] font-mono">`;
+    for (const [from, to, weight] of edges) {
+      const a = pos[from], b = pos[to];
+      if (!a || !b) continue;
+      if (from === to) {
+        html += `<circle cx="${a.x}" cy="${a.y - radius}" r="${radius / 2}" fill="none" class="stroke-muted-foreground" stroke-width="1.5" />`;
+        continue;
+      }
+      // Stop the line at the vertex circles so the arrowhead stays visible
+      const len = Math.hypot(b.x - a.x, b.y - a.y) || 1;
+      const dx = ((b.x - a.x) / len) * radius, dy = ((b.y - a.y) / len) * radius;
+      html += `<line x1="${a.x + dx}" y1="${a.y + dy}" x2="${b.x - dx}" y2="${b.y - dy}" class="stroke-muted-foreground" stroke-width="1.5"${directed ? ' marker-end="url(#arrowhead)"' : ''} />`;
+      if (weighted) {
+        html += `<text x="${(a.x + b.x) / 2}" y="${(a.y + b.y) / 2 - 3}" text-anchor="middle" font-size="9" class="fill-foreground">${escapeText(Number(weight))}</text>`;
+      }
+    }
+    vertices.forEach((name, i) => {
+      const { x, y } = pos[i];
+      html += `<circle cx="${x}" cy="${y}" r="${radius}" class="fill-background stroke-primary" stroke-width="1.5" />`;
+      html += `<text x="${x}" y="${y + 3}" text-anchor="middle" font-size="9" class="fill-foreground"><title>${i}: ${escapeText(name)}</title>${escapeText(String(name).slice(0, 4))}</text>`;
+    });
+    html += `</svg>`;
+    return html;
+  }
+
   /**
    * Render an array (Vector/Set) with indexed rows
    */
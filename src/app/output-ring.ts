@@ -0,0 +1,76 @@
+/**
+ * Single-producer, single-consumer byte ring in a SharedArrayBuffer that
+ * carries the running program's stdout/stderr from the worker to the UI.
+ *
+ * The worker appends UTF-8 bytes as the program writes; the main thread
+ * drains whatever has accumulated once per frame. This replaces one
+ * postMessage (and one change detection) per write. When the ring is
+ * full the writer blocks until the reader catches up, so no output is
+ * lost.
+ */
+const WRITE = 0;  // header slot: next byte the writer fills
+const READ = 1;   // header slot: next byte the reader takes
+const HEADER_BYTES = 8;
+
+export class OutputRing {
+  static readonly DEFAULT_CAPACITY = 1 << 20;
+
+  private readonly header: Int32Array;
+  private readonly data: Uint8Array;
+  private readonly capacity: number;
+  private readonly encoder = new TextEncoder();
+  private readonly decoder = new TextDecoder();
+
+  constructor(readonly buffer: SharedArrayBuffer) {
+    this.header = new Int32Array(buffer, 0, 2);
+    this.capacity = buffer.byteLength - HEADER_BYTES;
+    this.data = new Uint8Array(buffer, HEADER_BYTES, this.capacity);
+  }
+
+  static create(capacity = OutputRing.DEFAULT_CAPACITY): OutputRing {
+    return new OutputRing(new SharedArrayBuffer(HEADER_BYTES + capacity));
+  }
+
+  /** Worker side. Blocks (Atomics.wait) while the ring is full. */
+  write(text: string) {
+    const bytes = this.encoder.encode(text);
+    let offset = 0;
+    while (offset < bytes.length) {
+      const w = Atomics.load(this.header, WRITE);
+      const r = Atomics.load(this.header, READ);
+      // One byte stays empty so that a full ring differs from an empty one
+      const free = (r - w - 1 + this.capacity) % this.capacity;
+      if (free === 0) {
+        // Timeout guards against a missed notify
+        Atomics.wait(this.header, READ, r, 100);
+        continue;
+      }
+      const n = Math.min(free, bytes.length - offset, this.capacity - w);
+      this.data.set(bytes.subarray(offset, offset + n), w);
+      offset += n;
+      Atomics.store(this.header, WRITE, (w + n) % this.capacity);
+    }
+  }
+
+  /** Main-thread side. Returns everything written since the last drain. */
+  drain(): string {
+    const w = Atomics.load(this.header, WRITE);
+    const r = Atomics.load(this.header, READ);
+    if (w === r) return '';
+    // TextDecoder rejects views of shared memory, so copy out first
+    const bytes = w > r
+      ? this.data.slice(r, w)
+      : concatBytes(this.data.subarray(r), this.data.subarray(0, w));
+    Atomics.store(this.header, READ, w);
+    Atomics.notify(this.header, READ);
+    // stream: a multi-byte character may be split across drains
+    return this.decoder.decode(bytes, { stream: true });
+  }
+}
+
+function concatBytes(a: Uint8Array, b: Uint8Array): Uint8Array {
+  const out = new Uint8Array(a.length + b.length);
+  out.set(a, 0);
+  out.set(b, a.length);
+  return out;
+}